@@ -11,7 +11,6 @@ import "../../../../imports"
 import "../components"
 import "./samples/"
 import "./MessageComponents"
-import SortFilterProxyModel 0.2
 import im.status.desktop 1.0
 
 ScrollView {
@@ -22,7 +21,15 @@ ScrollView {
     property bool isActiveChat: false
     property int unreadMessagesWhileInactive: 0
     property int lastVisibleIndex: -1
+    // History is only requested once the chat is shown
+    function activateHistory() {
+        if(isActiveChat && messageList.activate) messageList.activate();
+    }
+
+    Component.onCompleted: activateHistory()
+
     onIsActiveChatChanged: {
+        activateHistory();
         if(isActiveChat){
             // Restore scroll
             chatLogView.currentIndex = lastVisibleIndex + unreadMessagesWhileInactive;
@@ -257,15 +264,25 @@ ScrollView {
             chatsModel.get(index).loadMoreMessages();
         });
 
+        // Lets the model evict the history far from what is on screen
+        property var reportViewport: Backpressure.oneInTime(chatLogView, 250, function() {
+            if(!messageList.setViewportEnd) return;
+            // Rows are newest first, so the oldest row on screen is the last one
+            const lastRow = Math.max(indexAt(width / 2, contentY + height - 1), indexAt(width / 2, contentY));
+            if(lastRow < 0) return;
+            messageList.setViewportEnd(lastRow);
+        });
+
         onContentYChanged: {
             scrollDownButton.visible = (contentHeight - (scrollY + height) > 400)
             if(scrollY < 500){
                 loadMsgs();
             }
+            reportViewport();
         }
 
 
-        model: messageListModel
+        model: messageList
         delegate: Message {
             id: msgDelegate
             chat: root.chat
@@ -287,23 +304,13 @@ ScrollView {
             linkUrls: model.linkUrls
             communityId: model.communityId
             hasMention: model.hasMention
-            prevMessageIndex: model.index === messageListModel.count - 1 ? -1 : model.index + 1
+            prevMessageIndex: model.index === chatLogView.count - 1 ? -1 : model.index + 1
             scrollToBottom: chatLogView.scrollToBottom
         }
         section.property: "sectionIdentifier"
         section.criteria: ViewSection.FullString
     }
 
-    SortFilterProxyModel {
-        id: messageListModel
-        sourceModel: messageList
-        sorters: ExpressionSorter {
-            expression: {
-                return modelLeft.clock > modelRight.clock;
-            }
-        }
-    }
-
     MessageDialog {
         id: sendingMsgFailedPopup
         standardButtons: StandardButton.Ok
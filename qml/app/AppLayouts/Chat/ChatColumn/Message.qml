@@ -20,7 +20,7 @@ Item {
     property string outgoingStatus: ""
     property string responseTo: ""
     property string messageId: ""
-    property string emojiReactions: ""
+    property var emojiReactions: []
     property int prevMessageIndex: -1
     property bool hasMention: false
     property string linkUrls: ""
@@ -30,7 +30,7 @@ Item {
     property string authorCurrentMsg: "authorCurrentMsg"
     property string authorPrevMsg: "authorPrevMsg"
 
-    property string prevMsgTimestamp: prevMessageIndex > - 1 ? messages.get(prevMessageIndex).timestamp : 0
+    property string prevMsgTimestamp: prevMessageIndex > - 1 ? messages.timestampAt(prevMessageIndex) : 0
     
     property bool shouldRepeatHeader: ((parseInt(timestamp, 10) - parseInt(prevMsgTimestamp, 10)) / 60 / 1000) > Constants.repeatHeaderInterval
 
@@ -62,33 +62,17 @@ Item {
             return []
         }
 
-        try {
-            // group by id
-            var allReactions = Object.values(JSON.parse(emojiReactions))
-            var byEmoji = {}
-            allReactions.forEach(function (reaction) {
-                if(reaction.retracted) return;
-                if (!byEmoji[reaction.emojiId]) {
-                    byEmoji[reaction.emojiId] = {
-                        emojiId: reaction.emojiId,
-                        fromAccounts: [],
-                        count: 0,
-                        currentUserReacted: false
-                    }
-                }
-                byEmoji[reaction.emojiId].count++;
-                byEmoji[reaction.emojiId].fromAccounts.push(Utils.getUsernameLabel(contactsModel.get_or_create(reaction.from), reaction.from === StatusSettings.PublicKey));
-                if (!byEmoji[reaction.emojiId].currentUserReacted && reaction.from === StatusSettings.PublicKey) {
-                    byEmoji[reaction.emojiId].currentUserReacted = true
-                }
-
-            })
-            return Object.values(byEmoji)
-        } catch (e) {
-            console.log(e);
-            console.error('Error parsing emoji reactions', e)
-            return []
-        }
+        // Reactions come grouped by emoji, only the author names are resolved here
+        return emojiReactions.map(function (reaction) {
+            return {
+                emojiId: reaction.emojiId,
+                count: reaction.count,
+                currentUserReacted: reaction.currentUserReacted,
+                fromAccounts: reaction.from.map(function (from) {
+                    return Utils.getUsernameLabel(contactsModel.get_or_create(from), from === StatusSettings.PublicKey)
+                })
+            }
+        })
     }
 
     Component {
@@ -126,7 +110,7 @@ Item {
         messageContextMenu.isSticker = isSticker
         messageContextMenu.emojiOnly = emojiOnly
         messageContextMenu.messageId = root.messageId;
-        messageContextMenu.show(JSON.parse(root.emojiReactions))
+        messageContextMenu.show(root.emojiReactionsModel)
         // Position the center of the menu where the mouse is
         messageContextMenu.x = messageContextMenu.x - messageContextMenu.width / 2;
         return messageContextMenu;
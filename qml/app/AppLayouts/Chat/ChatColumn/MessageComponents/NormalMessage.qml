@@ -284,7 +284,7 @@ Item {
 
     Loader {
         id: emojiReactionLoader
-        active: emojiReactions !== "[]"
+        active: emojiReactionsModel.length
         sourceComponent: emojiReactionsComponent
         anchors.left: root.isCurrentUser ? undefined : chatBox.left
         anchors.right: root.isCurrentUser ? chatBox.right : undefined
@@ -10,7 +10,7 @@ Rectangle {
     property var clickMessage: function () {}
     anchors.top: parent.top
     anchors.topMargin: 0
-    height: (isImage ? chatImageContent.height : chatText.height) + chatName.height + 2* Style.current.padding + (emojiReactions !== "" ? 20 : 0)
+    height: (isImage ? chatImageContent.height : chatText.height) + chatName.height + 2* Style.current.padding + (emojiReactionsModel.length ? 20 : 0)
     width: parent.width
     radius: Style.current.radius
     color: hovered ? Style.current.border : Style.current.background
@@ -145,7 +145,7 @@ Rectangle {
 
     Loader {
         id: emojiReactionLoader
-        active: emojiReactions !== ""
+        active: emojiReactionsModel.length
         sourceComponent: emojiReactionsComponent
         anchors.left: chatImage.right
         anchors.leftMargin: Style.current.halfPadding
@@ -117,7 +117,7 @@ Rectangle {
         id: deleteChatConfirmationDialog
         btnType: "warn"
         onConfirmButtonClicked: {
-            chatsModel.remove(index)
+            chatsModel.remove(chat.chatId)
             deleteChatConfirmationDialog.close()
         }
     }
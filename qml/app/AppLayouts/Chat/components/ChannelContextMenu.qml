@@ -7,7 +7,6 @@ import "../../../../imports"
 import im.status.desktop 1.0
 
 PopupMenu {
-    property int channelIndex
     property var contextChannel
 
     id: channelContextMenu
@@ -27,7 +26,6 @@ PopupMenu {
 
     function openMenu(index) {
         if (index !== undefined && index > -1) {
-            channelContextMenu.channelIndex = index;
             channelContextMenu.contextChannel = chatsModel.get(index);
         }
         channelContextMenu.popup()
@@ -63,7 +61,7 @@ PopupMenu {
                 openProfilePopup(true, contactsModel.get_or_create(channelContextMenu.contextChannel.id))
             }
             if (channelContextMenu.contextChannel.chatType == ChatType.PrivateGroupChat) {
-                openPopup(groupInfoPopupComponent, {channel: chatsModel.get(index)});
+                openPopup(groupInfoPopupComponent, {channel: channelContextMenu.contextChannel});
             }
         }
     }
@@ -80,11 +78,11 @@ PopupMenu {
         icon.width: 16
         icon.height: 16
         onTriggered: {
-            if (chatsModel.channelIsMuted(channelContextMenu.channelIndex)) {
-                chatsModel.unmuteChannel(channelContextMenu.channelIndex)
+            if (chatsModel.channelIsMuted(channelContextMenu.contextChannel.id)) {
+                chatsModel.unmuteChannel(channelContextMenu.contextChannel.id)
                 return
             }
-            chatsModel.muteChannel(channelContextMenu.channelIndex)
+            chatsModel.muteChannel(channelContextMenu.contextChannel.id)
         }
     }
 
@@ -94,7 +92,7 @@ PopupMenu {
         icon.source: "../../../img/check-circle.svg"
         icon.width: 16
         icon.height: 16
-        onTriggered:  chatsModel.markAllMessagesAsRead(channelContextMenu.channelIndex)
+        onTriggered:  chatsModel.markAllMessagesAsRead(channelContextMenu.contextChannel.id)
     }
     FetchMoreMessages {}
     Action {
@@ -103,7 +101,7 @@ PopupMenu {
         icon.source: "../../../img/close.svg"
         icon.width: 16
         icon.height: 16
-        onTriggered: chatsModel.deleteChatHistory(channelContextMenu.channelIndex)
+        onTriggered: chatsModel.deleteChatHistory(channelContextMenu.contextChannel.id)
     }
 
     Separator {}
@@ -131,7 +129,7 @@ PopupMenu {
         }
         icon.width: 16
         icon.height: 16
-        onTriggered: chatsModel.remove(channelContextMenu.channelIndex)
+        onTriggered: chatsModel.remove(channelContextMenu.contextChannel.id)
     }
 }
 
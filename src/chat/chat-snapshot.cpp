@@ -0,0 +1,75 @@
+#include "chat-snapshot.hpp"
+#include "constants.hpp"
+#include <QCborArray>
+#include <QCborMap>
+#include <QCborValue>
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QtEndian>
+
+namespace
+{
+
+const quint32 Magic = 0x4e535453; // "STSN"
+const quint32 Version = 2;
+const int HeaderSize = 8;
+
+} // namespace
+
+QString ChatSnapshot::path(const QString& publicKey)
+{
+	const QString account = QCryptographicHash::hash(publicKey.toUtf8(), QCryptographicHash::Sha256).toHex().left(16);
+	return Constants::applicationPath("/snapshots/" + account + ".bin");
+}
+
+bool ChatSnapshot::load(const QString& fileName)
+{
+	QFile file(fileName);
+	if(!file.open(QIODevice::ReadOnly) || file.size() <= HeaderSize) return false;
+
+	const uchar* data = file.map(0, file.size());
+	if(data == nullptr || qFromLittleEndian<quint32>(data) != Magic) return false;
+	if(qFromLittleEndian<quint32>(data + 4) != Version)
+	{
+		// Version 1 also saved the newest messages of each chat
+		file.remove();
+		return false;
+	}
+
+	// Decoded straight from the mapping, without reading the file into memory first
+	const QByteArray payload = QByteArray::fromRawData(reinterpret_cast<const char*>(data) + HeaderSize, file.size() - HeaderSize);
+	QCborParserError error;
+	const QCborMap snapshot = QCborValue::fromCbor(payload, &error).toMap();
+	if(error.error != QCborError::NoError)
+	{
+		qWarning() << "Could not read chat snapshot" << fileName << error.errorString();
+		return false;
+	}
+
+	chats = snapshot[QStringLiteral("chats")].toArray().toJsonArray();
+	contacts = snapshot[QStringLiteral("contacts")].toArray().toJsonArray();
+	return true;
+}
+
+bool ChatSnapshot::save(const QString& fileName) const
+{
+	QCborMap snapshot;
+	snapshot[QStringLiteral("chats")] = QCborArray::fromJsonArray(chats);
+	snapshot[QStringLiteral("contacts")] = QCborArray::fromJsonArray(contacts);
+
+	QByteArray header(HeaderSize, 0);
+	qToLittleEndian<quint32>(Magic, header.data());
+	qToLittleEndian<quint32>(Version, header.data() + 4);
+
+	QDir().mkpath(QFileInfo(fileName).absolutePath());
+	QSaveFile file(fileName);
+	if(!file.open(QIODevice::WriteOnly)) return false;
+	file.write(header);
+	file.write(QCborValue(snapshot).toCbor());
+	return file.commit();
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <QJsonArray>
+#include <QString>
+
+// The chat list and the contacts of one to one chats, saved so the next login can
+// display them before status-go answers. It is not encrypted, so it holds no
+// message text. The file is a small header followed by a CBOR document, and is
+// memory mapped to load
+class ChatSnapshot
+{
+public:
+	// One file per account
+	static QString path(const QString& publicKey);
+
+	bool load(const QString& fileName);
+	bool save(const QString& fileName) const;
+
+	QJsonArray chats;
+	QJsonArray contacts;
+};
@@ -3,6 +3,7 @@
 #include "constants.hpp"
 #include "content-type.hpp"
 #include "mailserver-cycle.hpp"
+#include "message-search.hpp"
 #include "messages-model.hpp"
 #include "settings.hpp"
 #include "status.hpp"
@@ -130,12 +131,19 @@ Chat::Chat(QObject* parent, const QJsonValue data)
 
 void Chat::update(const QJsonValue data)
 {
-	// TODO: replace by update instead of creating a new Message
-	delete m_lastMessage;
-	m_lastMessage = new Message(data["lastMessage"]);
-
-	m_lastMessage->setParent(this);
-	QQmlApplicationEngine::setObjectOwnership(m_lastMessage, QQmlApplicationEngine::CppOwnership);
+	// Chat updates often leave the last message as it was, and replacing it
+	// would refresh the chat list delegates for nothing
+	const QJsonValue lastMessage = data["lastMessage"];
+	if(m_lastMessage->get_id() != lastMessage["id"].toString() || m_lastMessage->get_text() != lastMessage["text"].toString())
+	{
+		// TODO: replace by update instead of creating a new Message
+		Message* previous = m_lastMessage;
+		Message* msg = new Message(lastMessage);
+		msg->setParent(this);
+		QQmlApplicationEngine::setObjectOwnership(msg, QQmlApplicationEngine::CppOwnership);
+		update_lastMessage(msg);
+		delete previous;
+	}
 
 	update_name(data["name"].toString());
 	update_timestamp(data["timestamp"].toString());
@@ -181,7 +189,7 @@ void Chat::sendMessage(QString message, QString replyTo, bool isEmoji)
 	QString preferredUsername = Settings::instance()->preferredName();
 	emit sendingMessage();
 
-	QtConcurrent::run([=] {
+	Status::instance()->rpcExecutor()->run(RpcExecutor::Interactive, [=] {
 		QMutexLocker locker(&m_mutex);
 		QJsonObject obj{
 			{"chatId", m_id},
@@ -209,7 +217,7 @@ void Chat::sendSticker(int packId, QString stickerHash)
 
 	Settings::instance()->addRecentSticker(packId, stickerHash);
 
-	QtConcurrent::run([=] {
+	Status::instance()->rpcExecutor()->run(RpcExecutor::Interactive, [=] {
 		QMutexLocker locker(&m_mutex);
 		QJsonObject obj{
 			{"chatId", m_id},
@@ -253,7 +261,7 @@ void Chat::sendImage(QString imagePath)
 	pixmap.save(&file, "jpeg", 75);
 	file.close();
 
-	QtConcurrent::run([=] {
+	Status::instance()->rpcExecutor()->run(RpcExecutor::Interactive, [=] {
 		QMutexLocker locker(&m_mutex);
 		QJsonObject obj{
 			{"chatId", m_id},
@@ -291,7 +299,7 @@ void Chat::leave()
 
 void Chat::loadFilter()
 {
-	QtConcurrent::run([=] {
+	Status::instance()->rpcExecutor()->run([=] {
 		QMutexLocker locker(&m_mutex);
 		QJsonObject obj{{"ChatID", m_id}, {"OneToOne", m_chatType == ChatType::OneToOne}};
 		const auto response = Status::instance()->callPrivateRPC("wakuext_loadFilters", QJsonArray{QJsonArray{obj}}.toVariantList()).toJsonObject();
@@ -321,16 +329,20 @@ void Chat::loadFilter()
 
 void Chat::deleteChatHistory()
 {
-	const auto response = Status::instance()->callPrivateRPC("wakuext_deleteMessagesByChatID", QJsonArray{m_id}.toVariantList()).toJsonObject();
-	if(!response["error"].isUndefined())
-	{
-		throw std::domain_error(response["error"]["message"].toString().toUtf8());
-	}
+	Status::instance()->callPrivateRPCAsync(
+		"wakuext_deleteMessagesByChatID", QJsonArray{m_id}.toVariantList(), this, [this](QJsonObject response) {
+			if(!response["error"].isUndefined())
+			{
+				qWarning() << "Could not delete chat history" << m_id << response["error"]["message"].toString();
+			}
+		});
 
 	auto msg = new Message(QJsonValue{});
 	msg->setParent(this);
 	QQmlApplicationEngine::setObjectOwnership(msg, QQmlApplicationEngine::CppOwnership);
 
+	MessageSearch::instance()->clearChat(m_id, m_lastClockValue.toULongLong());
+
 	update_lastMessage(msg);
 	update_unviewedMessagesCount(0);
 	m_messages->clear();
@@ -338,11 +350,12 @@ void Chat::deleteChatHistory()
 
 void Chat::markAllMessagesAsRead()
 {
-	const auto response = Status::instance()->callPrivateRPC("wakuext_markAllRead", QJsonArray{m_id}.toVariantList()).toJsonObject();
-	if(!response["error"].isUndefined())
-	{
-		throw std::domain_error(response["error"]["message"].toString().toUtf8());
-	}
+	Status::instance()->callPrivateRPCAsync("wakuext_markAllRead", QJsonArray{m_id}.toVariantList(), this, [this](QJsonObject response) {
+		if(!response["error"].isUndefined())
+		{
+			qWarning() << "Could not mark messages as read" << m_id << response["error"]["message"].toString();
+		}
+	});
 
 	update_unviewedMessagesCount(0);
 	save();
@@ -385,11 +398,15 @@ void Chat::save()
 					 {"chatType", m_chatType},
 					 {"timestamp", m_timestamp}};
 
-	const auto response = Status::instance()->callPrivateRPC("wakuext_saveChat", QJsonArray{chat}.toVariantList()).toJsonObject();
-	if(!response["error"].isUndefined())
-	{
-		throw std::domain_error(response["error"]["message"].toString().toUtf8());
-	}
+	Status::instance()->callPrivateRPCAsync("wakuext_saveChat", QJsonArray{chat}.toVariantList(), this, [this](QJsonObject response) {
+		if(!response["error"].isUndefined())
+		{
+			qWarning() << "Error saving chat: " << m_id << response["error"]["message"].toString();
+			emit saveFailed(response["error"]["message"].toString());
+			return;
+		}
+		emit saved();
+	});
 	//});
 }
 
@@ -398,68 +415,90 @@ uint qHash(const ChatMember& item, uint seed)
 	return qHash(item.id, seed);
 }
 
+QJsonObject Chat::toJson() const
+{
+	QJsonArray members;
+	foreach(const ChatMember& member, m_members)
+	{
+		members << QJsonObject{{"admin", member.admin}, {"id", member.id}, {"joined", member.joined}};
+	}
+
+	QJsonArray events;
+	foreach(const ChatMembershipEvent& event, m_membershipUpdateEvents)
+	{
+		events << QJsonObject{{"id", event.chatId},
+							  {"clockValue", event.clockValue},
+							  {"from", event.from},
+							  {"name", event.name},
+							  {"rawPayload", event.rawPayload},
+							  {"signature", event.signature},
+							  {"type", event.type}};
+	}
+
+	return QJsonObject{{"id", m_id},
+					   {"name", m_name},
+					   {"profile", m_profile},
+					   {"color", m_color},
+					   {"active", m_active},
+					   {"chatType", m_chatType},
+					   {"timestamp", m_timestamp},
+					   {"lastClockValue", m_lastClockValue},
+					   {"deletedAtClockValue", m_deletedAtClockValue},
+					   {"unviewedMessagesCount", m_unviewedMessagesCount},
+					   {"muted", m_muted},
+					   {"identicon", m_identicon},
+					   {"members", members},
+					   {"membershipUpdateEvents", events}};
+}
+
 QSet<ChatMember> Chat::getChatMembers()
 {
 	return m_members;
 }
 
-void Chat::renameGroup(QString newName)
+void Chat::updateGroup(QString method, QVariantList params)
 {
-	const auto response =
-		Status::instance()->callPrivateRPC("wakuext_changeGroupChatName", QJsonArray{QJsonValue(), m_id, newName}.toVariantList()).toJsonObject();
+	Status::instance()->callPrivateRPCAsync(method, params, this, [this](QJsonObject response) {
+		// TODO: error handling
+		Status::instance()->emitMessageSignal(response["result"].toObject());
+		emit groupDataChanged();
+	});
+}
 
-	// TODO: error handling
-	Status::instance()->emitMessageSignal(response["result"].toObject());
+void Chat::renameGroup(QString newName)
+{
+	updateGroup("wakuext_changeGroupChatName", QJsonArray{QJsonValue(), m_id, newName}.toVariantList());
 }
 
 void Chat::makeAdmin(QString memberId)
 {
-	const auto response = Status::instance()
-							  ->callPrivateRPC("wakuext_addAdminsToGroupChat", QJsonArray{QJsonValue(), m_id, QJsonArray{memberId}}.toVariantList())
-							  .toJsonObject();
-	// TODO: error handling
-	Status::instance()->emitMessageSignal(response["result"].toObject());
-
-	emit groupDataChanged();
+	updateGroup("wakuext_addAdminsToGroupChat", QJsonArray{QJsonValue(), m_id, QJsonArray{memberId}}.toVariantList());
 }
 
 void Chat::removeFromGroup(QString memberId)
 {
-	const auto response = Status::instance()
-							  ->callPrivateRPC("wakuext_removeMemberFromGroupChat", QJsonArray{QJsonValue(), m_id, memberId}.toVariantList())
-							  .toJsonObject();
-	// TODO: error handling
-	Status::instance()->emitMessageSignal(response["result"].toObject());
-
-	emit groupDataChanged();
+	updateGroup("wakuext_removeMemberFromGroupChat", QJsonArray{QJsonValue(), m_id, memberId}.toVariantList());
 }
 
 void Chat::addMembers(QStringList members)
 {
-	const auto response =
-		Status::instance()
-			->callPrivateRPC("wakuext_addMembersToGroupChat", QJsonArray{QJsonValue(), m_id, QJsonArray::fromStringList(members)}.toVariantList())
-			.toJsonObject();
-	// TODO: error handling
-	Status::instance()->emitMessageSignal(response["result"].toObject());
-
-	emit groupDataChanged();
+	updateGroup("wakuext_addMembersToGroupChat", QJsonArray{QJsonValue(), m_id, QJsonArray::fromStringList(members)}.toVariantList());
 }
 
 void Chat::join()
 {
-	const auto response = Status::instance()->callPrivateRPC("wakuext_confirmJoiningGroup", QJsonArray{m_id}.toVariantList()).toJsonObject();
-	// TODO: error handling
-	Status::instance()->emitMessageSignal(response["result"].toObject());
-	emit groupDataChanged();
+	updateGroup("wakuext_confirmJoiningGroup", QJsonArray{m_id}.toVariantList());
 }
 
 void Chat::leaveGroup()
 {
-	const auto response =
-		Status::instance()->callPrivateRPC("wakuext_leaveGroupChat", QJsonArray{QJsonValue(), m_id, true}.toVariantList()).toJsonObject();
-	// TODO: error handling
-	Status::instance()->emitMessageSignal(response["result"].toObject());
+	// The chat might be deleted before the response arrives, so the
+	// update is not bound to this object
+	Status::instance()->callPrivateRPCAsync(
+		"wakuext_leaveGroupChat", QJsonArray{QJsonValue(), m_id, true}.toVariantList(), Status::instance(), [](QJsonObject response) {
+			// TODO: error handling
+			Status::instance()->emitMessageSignal(response["result"].toObject());
+		});
 }
 
 void Chat::requestMoreMessages(qint64 from){
@@ -97,6 +97,8 @@ signals:
 	void messagesLoaded();
 	void topicCreated(Topic t);
 	void groupDataChanged();
+	void saved();
+	void saveFailed(QString message);
 
 private:
 	QMutex m_mutex;
@@ -105,6 +107,9 @@ private:
 
 public:
 	Q_INVOKABLE void save();
+
+	// Same shape as a wakuext_chats result, without the last message
+	QJsonObject toJson() const;
 	Q_INVOKABLE void sendMessage(QString message, QString replyTo, bool isEmoji);
 	Q_INVOKABLE void sendSticker(int packId, QString stickerHash);
 	Q_INVOKABLE void sendImage(QString imagePath);
@@ -129,6 +134,9 @@ public:
 	void leaveGroup();
 
 	QSet<ChatMember> getChatMembers();
+
+private:
+	void updateGroup(QString method, QVariantList params);
 };
 
 uint qHash(const ChatMember& item, uint seed = 0);
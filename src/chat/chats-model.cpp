@@ -1,4 +1,5 @@
 #include "chats-model.hpp"
+#include "chat-snapshot.hpp"
 #include "chat-type.hpp"
 #include "chat.hpp"
 #include "constants.hpp"
@@ -12,6 +13,7 @@
 #include "status.hpp"
 #include "utils.hpp"
 #include <QAbstractListModel>
+#include <QCoreApplication>
 #include <QDebug>
 #include <QJsonArray>
 #include <QJsonObject>
@@ -26,18 +28,43 @@ using namespace Messages;
 ChatsModel::ChatsModel(QObject* parent)
 	: QAbstractListModel(parent)
 {
+	m_contacts = nullptr;
+	m_mailservers = nullptr;
+	m_chatsLoadedMs = -1;
+	m_peakRssKB = 0;
+	m_prefetchCount = 5;
+	m_snapshotLoadMs = -1;
+	m_snapshotChatCount = 0;
+	m_changesScheduled = false;
+	m_startup.start();
+
+	bool ok;
+	const int prefetchCount = qEnvironmentVariableIntValue("STATUS_PREFETCH_CHATS", &ok);
+	if(ok) m_prefetchCount = std::max(0, prefetchCount);
+
 	QObject::connect(Status::instance(), &Status::message, this, &ChatsModel::update);
 	QObject::connect(this, &ChatsModel::joined, this, &ChatsModel::added);
 	QObject::connect(this, &ChatsModel::contactsChanged, this, &ChatsModel::onContactsChanged);
 	QObject::connect(this, &ChatsModel::mailserversChanged, this, &ChatsModel::onMailserversChanged);
+
+	// The snapshot is refreshed while the app runs, and written in place on the way out
+	m_snapshotPath = ChatSnapshot::path(Settings::instance()->publicKey());
+	m_snapshotTimer.setInterval(5 * 60 * 1000);
+	QObject::connect(&m_snapshotTimer, &QTimer::timeout, this, [this] { saveSnapshot(false); });
+	QObject::connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, [this] { saveSnapshot(true); });
+	QObject::connect(Status::instance(), &Status::logout, this, [this] {
+		m_snapshotTimer.stop();
+		saveSnapshot(true);
+	});
+
 	init();
 }
 
 void ChatsModel::init()
 {
+	// The messenger is started once the chats are loaded, see loadChats()
 	loadChats();
 	addTimelineChat();
-	startMessenger();
 }
 
 void ChatsModel::addTimelineChat()
@@ -51,26 +78,149 @@ void ChatsModel::onContactsChanged()
 {
 	QObject::connect(m_contacts, &ContactsModel::contactToggled, this, &ChatsModel::toggleTimelineChat);
 
+	// Chat rows need the contacts, so the snapshot can only be shown from here
+	if(m_chatsLoadedMs < 0) loadSnapshot();
+
 	// Loading messages for timeline chats
 	m_chatMap[Constants::getTimelineChatId()]->get_messages()->set_contacts(m_contacts);
 	foreach(Chat* chat, m_timelineChats)
 	{
-		chat->get_messages()->set_contacts(m_contacts);
-		chat->get_messages()->loadMessages();
-		chat->get_messages()->loadReactions();
+		loadChatHistory(chat);
 	}
 
-	// Loading messages for standard chats
+	// Standard chats load their messages when first shown
 	foreach(Chat* chat, m_chats)
 	{
-		chat->get_messages()->set_contacts(m_contacts);
-		chat->get_messages()->loadMessages();
-		chat->get_messages()->loadReactions();
+		loadChatHistory(chat);
+	}
 
+	prefetchHistory();
+}
+
+void ChatsModel::loadChatHistory(Chat* chat)
+{
+	chat->get_messages()->set_contacts(m_contacts);
+
+	if(chat->get_chatType() == ChatType::Profile || chat->get_chatType() == ChatType::Timeline)
+	{
+		// Status updates are needed by the timeline before any of these chats is shown
+		chat->get_messages()->activate();
+	}
+	else
+	{
 		m_contacts->upsert(chat);
 	}
 }
 
+void ChatsModel::prefetchHistory()
+{
+	if(m_contacts == nullptr || m_prefetchCount == 0) return;
+
+	// The most recently active chats, at the top of the list, are the likely first
+	// picks. Their history is requested on the background lane, so it never delays
+	// the chat being opened
+	for(int i = 0; i < m_chats.size() && i < m_prefetchCount; i++)
+	{
+		m_chats[i]->get_messages()->prefetch();
+	}
+}
+
+QVariantMap ChatsModel::startupStats() const
+{
+	int activated = 0;
+	foreach(Chat* chat, m_chats)
+	{
+		if(chat->get_messages()->isActivated()) activated++;
+	}
+
+	return QVariantMap{{"chatsLoadedMs", m_chatsLoadedMs},
+					   {"peakRssKb", m_peakRssKB},
+					   {"chats", m_chats.size()},
+					   {"historiesRequested", activated},
+					   {"prefetchCount", m_prefetchCount},
+					   {"snapshotChats", m_snapshotChatCount},
+					   {"snapshotLoadMs", m_snapshotLoadMs}};
+}
+
+void ChatsModel::loadSnapshot()
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	ChatSnapshot snapshot;
+	if(!snapshot.load(m_snapshotPath)) return;
+
+	foreach(const QJsonValue& value, snapshot.contacts)
+	{
+		if(m_contacts->get(value["id"].toString()) == nullptr) m_contacts->push(new Contact(value));
+	}
+
+	foreach(const QJsonValue& value, snapshot.chats)
+	{
+		if(m_chatMap.contains(value["id"].toString())) continue;
+
+		Chat* c = new Chat(this, value);
+		const int row = insert(c);
+		m_snapshotChats << c->get_id();
+		emit added(c->get_chatType(), c->get_id(), row);
+	}
+
+	m_snapshotChatCount = m_snapshotChats.size();
+	m_snapshotLoadMs = timer.elapsed();
+	qInfo() << "Restored" << m_snapshotChatCount << "chats from snapshot in" << m_snapshotLoadMs << "ms";
+}
+
+void ChatsModel::removeSnapshotChats(const QSet<QString>& active)
+{
+	// Chats left or deleted elsewhere since the snapshot was taken. They were never
+	// joined in this session, so only their rows go away
+	foreach(const QString& id, m_snapshotChats)
+	{
+		if(active.contains(id)) continue;
+
+		Chat* chat = m_chatMap.take(id);
+		const int row = rowOf(chat);
+		if(row < 0) continue;
+
+		beginRemoveRows(QModelIndex(), row, row);
+		m_chats.remove(row);
+		m_rowActivity.remove(chat);
+		endRemoveRows();
+		m_changes.remove(chat);
+		left(row);
+		chat->deleteLater();
+	}
+
+	m_snapshotChats.clear();
+}
+
+void ChatsModel::saveSnapshot(bool wait)
+{
+	// Before wakuext_chats answers, the chat list may still be the old snapshot
+	if(m_chatsLoadedMs < 0 || m_contacts == nullptr) return;
+
+	ChatSnapshot snapshot;
+	foreach(Chat* chat, m_chats)
+	{
+		snapshot.chats << chat->toJson();
+		if(chat->get_chatType() != ChatType::OneToOne) continue;
+
+		Contact* contact = m_contacts->get(chat->get_id());
+		if(contact != nullptr) snapshot.contacts << contact->toJson();
+	}
+
+	const QString path = m_snapshotPath;
+	if(wait)
+	{
+		snapshot.save(path);
+		return;
+	}
+
+	Status::instance()->rpcExecutor()->run(RpcExecutor::Background, [snapshot, path] {
+		if(!snapshot.save(path)) qWarning() << "Could not save chat snapshot" << path;
+	});
+}
+
 void ChatsModel::onMailserversChanged()
 {
 	foreach(Chat* chat, m_timelineChats)
@@ -146,7 +296,7 @@ void ChatsModel::pushStatusUpdate(Message* msg)
 	m_chatMap[Constants::getTimelineChatId()]->get_messages()->push(msg);
 }
 
-void ChatsModel::insert(Chat* chat)
+int ChatsModel::insert(Chat* chat)
 {
 	QQmlApplicationEngine::setObjectOwnership(chat, QQmlApplicationEngine::CppOwnership);
 	chat->setParent(this);
@@ -163,79 +313,216 @@ void ChatsModel::insert(Chat* chat)
 	}
 	else
 	{
-		beginInsertRows(QModelIndex(), rowCount(), rowCount());
-		m_chats << chat;
+		const int row = sortedRow(chat);
+		beginInsertRows(QModelIndex(), row, row);
+		m_chats.insert(row, chat);
+		m_rowActivity[chat] = activity(chat);
 		endInsertRows();
+
+		// Each property only refreshes the roles that show it
+		QObject::connect(chat, &Chat::nameChanged, this, [this, chat] { changed(chat, {Name}); });
+		QObject::connect(chat, &Chat::colorChanged, this, [this, chat] { changed(chat, {Color}); });
+		QObject::connect(chat, &Chat::identiconChanged, this, [this, chat] { changed(chat, {Identicon}); });
+		QObject::connect(chat, &Chat::mutedChanged, this, [this, chat] { changed(chat, {Muted}); });
+		QObject::connect(chat, &Chat::unviewedMessagesCountChanged, this, [this, chat] { changed(chat, {UnreadMessages}); });
+		QObject::connect(chat, &Chat::hasMentionsChanged, this, [this, chat] { changed(chat, {HasMentions}); });
+		QObject::connect(chat, &Chat::lastMessageChanged, this, [this, chat] { changed(chat, {LastMessage, ContentType}); });
+		QObject::connect(chat, &Chat::groupDataChanged, this, [this, chat] { changed(chat, {ChatMembers}); });
+		QObject::connect(chat, &Chat::timestampChanged, this, [this, chat] {
+			reposition(chat);
+			changed(chat, {Timestamp});
+		});
+		return row;
 	}
+	return -1;
+}
+
+qint64 ChatsModel::activity(Chat* chat)
+{
+	return chat->get_timestamp().toLongLong();
+}
+
+int ChatsModel::sortedRow(Chat* chat, int exclude) const
+{
+	// Binary search over the rows, skipping `exclude`. Chats with the same activity
+	// keep their order, and the new one goes after them
+	const qint64 key = activity(chat);
+	int low = 0;
+	int high = m_chats.size() - (exclude < 0 ? 0 : 1);
+	while(low < high)
+	{
+		const int mid = (low + high) / 2;
+		const int row = exclude >= 0 && mid >= exclude ? mid + 1 : mid;
+		if(m_rowActivity[m_chats[row]] >= key)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	return low;
+}
+
+int ChatsModel::rowOf(Chat* chat) const
+{
+	if(!m_rowActivity.contains(chat)) return -1;
+
+	// First row placed with the same activity, then through the chats that share it
+	const qint64 key = m_rowActivity[chat];
+	int low = 0;
+	int high = m_chats.size();
+	while(low < high)
+	{
+		const int mid = (low + high) / 2;
+		if(m_rowActivity[m_chats[mid]] > key)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	for(int row = low; row < m_chats.size() && m_rowActivity[m_chats[row]] == key; row++)
+	{
+		if(m_chats[row] == chat) return row;
+	}
+	return -1;
+}
+
+void ChatsModel::reposition(Chat* chat)
+{
+	const int row = rowOf(chat);
+	if(row < 0) return;
+
+	const int to = sortedRow(chat, row);
+	m_rowActivity[chat] = activity(chat);
+	if(to == row) return;
+
+	// Moving down, the destination is the row after the one the chat ends up at
+	beginMoveRows(QModelIndex(), row, row, QModelIndex(), to > row ? to + 1 : to);
+	m_chats.move(row, to);
+	endMoveRows();
+}
+
+void ChatsModel::changed(Chat* chat, const QVector<int>& roles)
+{
+	m_changes.add(chat, roles);
+	if(m_changesScheduled) return;
+	m_changesScheduled = true;
+	QTimer::singleShot(0, this, &ChatsModel::flushChanges);
+}
+
+void ChatsModel::flushChanges()
+{
+	m_changesScheduled = false;
+	m_changes.flush(this, [this](Chat* chat) { return rowOf(chat); });
 }
 
 void ChatsModel::join(ChatType chatType, QString id, QString ensName)
 {
 	if(!m_chatMap.contains(id))
 	{
-		qDebug() << "Chat does not exist. Creating chat: " << id << ensName;
-		try
-		{
-			Chat* c = new Chat(this, id, chatType, ensName);
-			c->save();
+		if(m_joining.contains(id)) return;
+		m_joining << id;
 
-			m_contacts->upsert(c);
+		qDebug() << "Chat does not exist. Creating chat: " << id << ensName;
+		Chat* c = new Chat(this, id, chatType, ensName);
 
-			QObject::connect(c, &Chat::topicCreated, m_mailservers->getCycle(), &MailserverCycle::addChannelTopic);
+		// The chat is only added once status-go saved it, so a failed join leaves nothing behind
+		QObject::connect(c, &Chat::saved, this, [this, c] {
+			QObject::disconnect(c, &Chat::saved, this, nullptr);
+			QObject::disconnect(c, &Chat::saveFailed, this, nullptr);
+			m_joining.remove(c->get_id());
 
-			insert(c);
+			// A signal might have brought the chat in the meantime
+			if(m_chatMap.contains(c->get_id()))
+			{
+				emit joined(c->get_chatType(), c->get_id(), rowOf(m_chatMap[c->get_id()]));
+				c->deleteLater();
+				return;
+			}
 
+			m_contacts->upsert(c);
+			QObject::connect(c, &Chat::topicCreated, m_mailservers->getCycle(), &MailserverCycle::addChannelTopic);
+			const int row = insert(c);
 			c->loadFilter();
-			emit joined(chatType, id, m_chats.count() - 1);
-		}
-		catch(const std::exception& e)
-		{
-			qWarning() << "Error saving chat: " << e.what();
-			emit joinError(e.what());
-		}
-		qDebug() << "Chat saved";
+			emit joined(c->get_chatType(), c->get_id(), row);
+		});
+		QObject::connect(c, &Chat::saveFailed, this, [this, c](QString message) {
+			m_joining.remove(c->get_id());
+			c->deleteLater();
+			emit joinError(message);
+		});
+		c->save();
 	}
 	else
 	{
 		// Channel already joined
-		int chatIndex = m_chats.indexOf(m_chatMap[id]);
+		int chatIndex = rowOf(m_chatMap[id]);
 		emit joined(chatType, id, chatIndex);
 	}
 }
 
 void ChatsModel::createGroup(QString groupName, QStringList members)
 {
-	const auto response = Status::instance()
-							  ->callPrivateRPC("wakuext_createGroupChatWithMembers",
-											   QJsonArray{QJsonValue(), groupName, QJsonArray::fromStringList(members)}.toVariantList())
-							  .toJsonObject();
-	// TODO: error handling
-	Status::instance()->emitMessageSignal(response["result"].toObject());
-
-	// TO
-	emit joined(ChatType::PrivateGroupChat, m_chats[m_chats.count() - 1]->get_id(), m_chats.count() - 1);
+	Status::instance()->callPrivateRPCAsync(
+		"wakuext_createGroupChatWithMembers",
+		QJsonArray{QJsonValue(), groupName, QJsonArray::fromStringList(members)}.toVariantList(),
+		this,
+		[this](QJsonObject response) {
+			// TODO: error handling
+			Status::instance()->emitMessageSignal(response["result"].toObject());
+
+			// The chat was inserted by the signal, at the row of its activity
+			const QJsonArray chats = response["result"]["chats"].toArray();
+			if(chats.isEmpty()) return;
+			const QString id = chats[0]["id"].toString();
+			emit joined(ChatType::PrivateGroupChat, id, rowOf(m_chatMap.value(id)));
+		});
 }
 
 void ChatsModel::startMessenger()
 {
-	const auto response = Status::instance()->callPrivateRPC("wakuext_startMessenger", QJsonArray{}.toVariantList()).toJsonObject();
 	// TODO: do something with mailservers/ranges?
+	Status::instance()->callPrivateRPCAsync("wakuext_startMessenger", QJsonArray{}.toVariantList(), RpcExecutor::Normal);
 }
 
 void ChatsModel::loadChats()
 {
-	const auto response = Status::instance()->callPrivateRPC("wakuext_chats", QJsonArray{}.toVariantList()).toJsonObject();
+	auto onChatsLoaded = [this](QJsonObject response) {
+		startMessenger();
 
-	if(response["result"].isNull()) return;
+		if(response["result"].isNull()) return;
 
-	foreach(const QJsonValue& value, response["result"].toArray())
-	{
-		const QJsonObject obj = value.toObject();
-		if(!value["active"].toBool()) continue;
-		Chat* c = new Chat(this, obj);
-		insert(c);
-		emit added(c->get_chatType(), c->get_id(), m_chats.count() - 1);
-	}
+		QSet<QString> active;
+		foreach(const QJsonValue& value, response["result"].toArray())
+		{
+			const QJsonObject obj = value.toObject();
+			if(!value["active"].toBool()) continue;
+			active << obj["id"].toString();
+
+			// The snapshot or a signal might have created the chat before the response arrived
+			if(m_chatMap.contains(obj["id"].toString()))
+			{
+				Chat* chat = m_chatMap[obj["id"].toString()];
+				if(m_snapshotChats.contains(chat->get_id()) && m_chats.contains(chat)) chat->update(value);
+				continue;
+			}
+
+			Chat* c = new Chat(this, obj);
+			const int row = insert(c);
+			emit added(c->get_chatType(), c->get_id(), row);
+
+			// Contacts are usually set before the chats finish loading
+			if(m_contacts != nullptr) loadChatHistory(c);
+		}
+
+		removeSnapshotChats(active);
+		prefetchHistory();
+
+		m_chatsLoadedMs = m_startup.elapsed();
+		m_peakRssKB = Utils::peakResidentKB();
+		qInfo() << "Chats loaded in" << m_chatsLoadedMs << "ms, peak RSS" << m_peakRssKB << "KB";
+
+		m_snapshotTimer.start();
+	};
+
+	Status::instance()->callPrivateRPCAsync("wakuext_chats", QJsonArray{}.toVariantList(), this, onChatsLoaded, RpcExecutor::Normal);
 }
 
 Chat* ChatsModel::get(int row) const
@@ -247,11 +534,13 @@ Chat* ChatsModel::get(int row) const
 void ChatsModel::removeFilterRPC(QString chatId, QString filterId)
 {
 	QJsonObject obj{{"ChatID", chatId}, {"FilterID", filterId}};
-	const auto response = Status::instance()->callPrivateRPC("wakuext_removeFilters", QJsonArray{QJsonArray{obj}}.toVariantList()).toJsonObject();
-	if(!response["error"].isUndefined())
-	{
-		throw std::domain_error(response["error"]["message"].toString().toUtf8());
-	}
+	Status::instance()->callPrivateRPCAsync(
+		"wakuext_removeFilters", QJsonArray{QJsonArray{obj}}.toVariantList(), this, [chatId](QJsonObject response) {
+			if(!response["error"].isUndefined())
+			{
+				qWarning() << "Could not remove filter for chat: " << chatId << response["error"]["message"].toString();
+			}
+		});
 }
 
 void ChatsModel::remove1on1Filters(QString chatId, QJsonArray filters)
@@ -297,99 +586,110 @@ void ChatsModel::remove1on1Filters(QString chatId, QJsonArray filters)
 
 void ChatsModel::removeFilter(Chat* c)
 {
-	const auto response = Status::instance()->callPrivateRPC("wakuext_filters", QJsonArray{}.toVariantList()).toJsonObject();
-	QJsonArray filters = response["result"].toArray();
+	// The chat is deleted right after this call, so only its data is captured
+	QString chatId = c->get_id();
+	ChatType chatType = c->get_chatType();
+	QSet<ChatMember> chatMembers = c->getChatMembers();
 
-	switch(c->get_chatType())
-	{
-	case ChatType::Profile:
-	case ChatType::Public: {
-		foreach(const QJsonValue& filterJson, filters)
-		{
-			const QJsonObject filter = filterJson.toObject();
-			if(filter["chatId"].toString() == c->get_id())
-			{
-				removeFilterRPC(c->get_id(), filter["filterId"].toString());
-			}
-		}
-	}
-	break;
-	case ChatType::OneToOne: {
-		// Check if user does not belong to any active chat group
-		bool inGroup = false;
-		ChatMember member;
-		member.id = c->get_id();
-		foreach(Chat* chat, m_chats)
-		{
-			if(chat->get_active() && chat->get_chatType() == ChatType::PrivateGroupChat && chat->getChatMembers().contains(member))
-			{
-				inGroup = true;
-			}
-		}
+	Status::instance()->callPrivateRPCAsync(
+		"wakuext_filters", QJsonArray{}.toVariantList(), this, [this, chatId, chatType, chatMembers](QJsonObject response) {
+			QJsonArray filters = response["result"].toArray();
 
-		if(!inGroup)
-		{
-			remove1on1Filters(c->get_id(), filters);
-		}
-	}
-	break;
-	case ChatType::PrivateGroupChat: {
-		foreach(const ChatMember& member, c->getChatMembers())
-		{
-			// Check that any of the members are not in other active group chats, or that you don’t have a one-to-one open.
-			bool hasConversation = false;
-			foreach(Chat* chat, m_chats)
+			switch(chatType)
 			{
-				if((chat->get_active() && chat->get_chatType() == ChatType::OneToOne && chat->get_id() == member.id) ||
-				   (chat->get_active() && chat->get_id() != c->get_id() && chat->get_chatType() == ChatType::PrivateGroupChat &&
-					chat->getChatMembers().contains(member)))
+			case ChatType::Profile:
+			case ChatType::Public: {
+				foreach(const QJsonValue& filterJson, filters)
 				{
-					hasConversation = true;
-					break;
+					const QJsonObject filter = filterJson.toObject();
+					if(filter["chatId"].toString() == chatId)
+					{
+						removeFilterRPC(chatId, filter["filterId"].toString());
+					}
 				}
 			}
+			break;
+			case ChatType::OneToOne: {
+				// Check if user does not belong to any active chat group
+				bool inGroup = false;
+				ChatMember member;
+				member.id = chatId;
+				foreach(Chat* chat, m_chats)
+				{
+					if(chat->get_active() && chat->get_chatType() == ChatType::PrivateGroupChat && chat->getChatMembers().contains(member))
+					{
+						inGroup = true;
+					}
+				}
 
-			if(!hasConversation)
-			{
-				if(m_chatMap.contains(member.id))
+				if(!inGroup)
 				{
-					remove1on1Filters(member.id, filters);
+					remove1on1Filters(chatId, filters);
 				}
 			}
-		}
-	}
-	break;
-	default: qWarning() << "Unhandled chatType" << c->get_id() << c->get_chatType();
-	}
+			break;
+			case ChatType::PrivateGroupChat: {
+				foreach(const ChatMember& member, chatMembers)
+				{
+					// Check that any of the members are not in other active group chats, or that you don’t have a one-to-one open.
+					bool hasConversation = false;
+					foreach(Chat* chat, m_chats)
+					{
+						if((chat->get_active() && chat->get_chatType() == ChatType::OneToOne && chat->get_id() == member.id) ||
+						   (chat->get_active() && chat->get_id() != chatId && chat->get_chatType() == ChatType::PrivateGroupChat &&
+							chat->getChatMembers().contains(member)))
+						{
+							hasConversation = true;
+							break;
+						}
+					}
+
+					if(!hasConversation)
+					{
+						if(m_chatMap.contains(member.id))
+						{
+							remove1on1Filters(member.id, filters);
+						}
+					}
+				}
+			}
+			break;
+			default: qWarning() << "Unhandled chatType" << chatId << chatType;
+			}
+		});
 
-	m_mailservers->getCycle()->removeMailserverTopicForChat(c->get_id());
+	MailserverCycle* cycle = m_mailservers->getCycle();
+	Status::instance()->rpcExecutor()->run(RpcExecutor::Background, [cycle, chatId] { cycle->removeMailserverTopicForChat(chatId); });
 }
 
-void ChatsModel::remove(int row)
+void ChatsModel::remove(QString id)
 {
-	removeFilter(m_chats[row]);
+	// Timeline and profile chats are in m_chatMap too, but aren't rows and can't be left
+	Chat* chat = m_chatMap.value(id);
+	const int row = rowOf(chat);
+	if(row < 0) return;
 
-	m_chats[row]->leave();
-	m_chatMap.remove(m_chats[row]->get_id());
+	removeFilter(chat);
+
+	chat->leave();
+	m_chatMap.remove(id);
 	beginRemoveRows(QModelIndex(), row, row);
-	delete m_chats[row];
+	m_changes.remove(chat);
+	m_rowActivity.remove(chat);
+	delete chat;
 	m_chats.remove(row);
 	endRemoveRows();
 	left(row);
 }
 
-void ChatsModel::markAllMessagesAsRead(int row)
+void ChatsModel::markAllMessagesAsRead(QString id)
 {
-	m_chats[row]->markAllMessagesAsRead();
-	QModelIndex idx = createIndex(row, 0);
-	dataChanged(idx, idx);
+	if(m_chatMap.contains(id)) m_chatMap[id]->markAllMessagesAsRead();
 }
 
-void ChatsModel::deleteChatHistory(int row)
+void ChatsModel::deleteChatHistory(QString id)
 {
-	m_chats[row]->deleteChatHistory();
-	QModelIndex idx = createIndex(row, 0);
-	dataChanged(idx, idx);
+	if(m_chatMap.contains(id)) m_chatMap[id]->deleteChatHistory();
 }
 
 void ChatsModel::update(QJsonValue updates)
@@ -400,27 +700,23 @@ void ChatsModel::update(QJsonValue updates)
 		QString chatId = chatJson["id"].toString();
 		if(m_chatMap.contains(chatId))
 		{
-			int chatIndex = m_chats.indexOf(m_chatMap[chatId]);
 			m_chatMap[chatId]->update(chatJson);
-			if(chatIndex > -1)
-			{
-				QModelIndex idx = createIndex(chatIndex, 0);
-				dataChanged(idx, idx);
-			}
 		}
 		else
 		{
 			Chat* newChat = new Chat(this, chatJson);
 			m_contacts->upsert(newChat);
-			insert(newChat);
-			emit added(newChat->get_chatType(), newChat->get_id(), m_chats.count() - 1);
+			const int row = insert(newChat);
+			emit added(newChat->get_chatType(), newChat->get_id(), row);
 		}
 		// TODO: tell @cammellos that the messages are not returning the ens name
 		m_contacts->upsert(m_chatMap[chatId]->get_lastMessage());
 		m_contacts->upsert(m_chatMap[chatId]);
 	}
 
-	// Messages
+	// Messages are grouped by chat, so each model receives a single insert
+	QVector<QString> updatedChats;
+	QHash<QString, QVector<Message*>> messagesByChat;
 	foreach(QJsonValue msgJson, updates["messages"].toArray())
 	{
 		Message* message = new Message(msgJson);
@@ -428,19 +724,24 @@ void ChatsModel::update(QJsonValue updates)
 		QString chatId = Constants::getTimelineChatId(message->get_from()) == message->get_localChatId() ? Constants::getTimelineChatId()
 																										 : message->get_localChatId();
 
-		m_chatMap[chatId]->get_messages()->push(message);
-		if(message->get_hasMention())
+		if(!m_chatMap.contains(chatId))
 		{
-			m_chatMap[chatId]->update_hasMentions(true);
-			int chatIndex = m_chats.indexOf(m_chatMap[chatId]);
-			if(chatIndex > -1)
-			{
-				QModelIndex idx = createIndex(chatIndex, 0);
-				dataChanged(idx, idx);
-			}
+			qWarning() << "Received message for unknown chat: " << chatId;
+			delete message;
+			continue;
 		}
+
+		if(message->get_hasMention()) m_chatMap[chatId]->update_hasMentions(true);
 		// Create a contact if necessary
 		m_contacts->upsert(message);
+
+		if(!messagesByChat.contains(chatId)) updatedChats << chatId;
+		messagesByChat[chatId] << message;
+	}
+
+	foreach(const QString& chatId, updatedChats)
+	{
+		m_chatMap[chatId]->get_messages()->push(messagesByChat[chatId]);
 	}
 
 	// Emoji reactions
@@ -6,11 +6,17 @@
 #include "message.hpp"
 #include "mailserver-model.hpp"
 #include "mailserver-cycle.hpp"
+#include "role-changes.hpp"
 #include <QAbstractListModel>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QHash>
+#include <QJsonArray>
 #include <QQmlHelpers>
+#include <QSet>
+#include <QTimer>
 #include <QVariantList>
+#include <QVariantMap>
 #include <QVector>
 
 class ChatsModel : public QAbstractListModel
@@ -48,9 +54,10 @@ public:
 	Q_INVOKABLE void createGroup(QString groupName, QStringList members);
 
 	Q_INVOKABLE Chat* get(int row) const;
-	Q_INVOKABLE void remove(int row);
-	Q_INVOKABLE void markAllMessagesAsRead(int row);
-	Q_INVOKABLE void deleteChatHistory(int row);
+	// Chats are identified by id, as their rows move whenever a message arrives
+	Q_INVOKABLE void remove(QString id);
+	Q_INVOKABLE void markAllMessagesAsRead(QString id);
+	Q_INVOKABLE void deleteChatHistory(QString id);
 
 	Q_PROPERTY(QVariant timelineMessages READ timelineMessages CONSTANT)
 	Q_INVOKABLE QVariant timelineMessages();
@@ -63,6 +70,10 @@ public:
 	Q_INVOKABLE void onContactsChanged();
 	Q_INVOKABLE void onMailserversChanged();
 
+	// Time until the chat list was loaded, peak memory at that point, how many
+	// chat histories have been requested since and what the snapshot restored
+	Q_INVOKABLE QVariantMap startupStats() const;
+
 signals:
 	void joinError(QString message);
 	void joined(ChatType chatType, QString id, int index);
@@ -73,8 +84,23 @@ signals:
 private:
 	void startMessenger();
 	void loadChats();
+	void loadSnapshot();
+	void saveSnapshot(bool wait);
+	void removeSnapshotChats(const QSet<QString>& active);
+	void loadChatHistory(Chat* chat);
+	void prefetchHistory();
 	void update(QJsonValue updates);
-	void insert(Chat* chat);
+	// Returns the row of the chat, or -1 for timeline chats, which have none
+	int insert(Chat* chat);
+	// Moves a chat whose activity changed to its place
+	void reposition(Chat* chat);
+	// Records the roles a chat changed, announced together once control returns to the event loop
+	void changed(Chat* chat, const QVector<int>& roles);
+	void flushChanges();
+	int sortedRow(Chat* chat, int exclude = -1) const;
+	// Binary search for the row of a chat, -1 if it has none
+	int rowOf(Chat* chat) const;
+	static qint64 activity(Chat* chat);
 	void addTimelineChat();
 	void removeFilter(Chat* chat);
 
@@ -82,7 +108,29 @@ private:
 	void remove1on1Filters(QString chatId, QJsonArray filters);
 	void removeFilterRPC(QString chatId, QString filterId);
 
+	// Ordered by last activity, newest first
 	QVector<Chat*> m_chats;
+	// Activity each row was placed by. The rows stay sorted by it even while a chat's
+	// timestamp changed and it wasn't moved yet, so rowOf() can search them
+	QHash<Chat*, qint64> m_rowActivity;
 	QVector<Chat*> m_timelineChats;
 	QHash<QString, Chat*> m_chatMap;
+	// Chats being joined, shown once wakuext_saveChat succeeds
+	QSet<QString> m_joining;
+
+	RoleChanges<Chat*> m_changes;
+	bool m_changesScheduled;
+
+	// STATUS_PREFETCH_CHATS overrides the number of recent chats loaded ahead, 0 disables it
+	int m_prefetchCount;
+	QElapsedTimer m_startup;
+	qint64 m_chatsLoadedMs;
+	qint64 m_peakRssKB;
+
+	// Chats shown from the snapshot until wakuext_chats answers
+	QSet<QString> m_snapshotChats;
+	QString m_snapshotPath;
+	qint64 m_snapshotLoadMs;
+	int m_snapshotChatCount;
+	QTimer m_snapshotTimer;
 };
@@ -0,0 +1,110 @@
+#include "message-budget.hpp"
+#include "messages-model.hpp"
+#include <QTimer>
+#include <algorithm>
+
+MessageBudget* MessageBudget::theInstance;
+
+MessageBudget* MessageBudget::instance()
+{
+	if(theInstance == 0) theInstance = new MessageBudget();
+	return theInstance;
+}
+
+MessageBudget::MessageBudget(QObject* parent)
+	: QObject(parent)
+	, m_window(100)
+	, m_budget(20000)
+	, m_scheduled(false)
+	, m_trims(0)
+	, m_evicted(0)
+{
+	bool ok;
+	const int window = qEnvironmentVariableIntValue("STATUS_MESSAGE_WINDOW", &ok);
+	if(ok) setWindow(window);
+	const int budget = qEnvironmentVariableIntValue("STATUS_MESSAGE_BUDGET", &ok);
+	if(ok) setBudget(budget);
+}
+
+int MessageBudget::window() const
+{
+	return m_window;
+}
+
+void MessageBudget::setWindow(int value)
+{
+	// At least one page, so a chat always has something to show
+	m_window = std::max(20, value);
+}
+
+int MessageBudget::budget() const
+{
+	return m_budget;
+}
+
+void MessageBudget::setBudget(int value)
+{
+	m_budget = std::max(m_window, value);
+	schedule();
+}
+
+void MessageBudget::add(MessagesModel* model)
+{
+	m_models.prepend(model);
+	QObject::connect(model, &QObject::destroyed, this, [this, model] { m_models.removeOne(model); });
+}
+
+void MessageBudget::touch(MessagesModel* model)
+{
+	if(!m_models.isEmpty() && m_models.last() == model) return;
+
+	m_models.removeOne(model);
+	m_models << model;
+}
+
+void MessageBudget::schedule()
+{
+	if(m_scheduled) return;
+	m_scheduled = true;
+	QTimer::singleShot(0, this, &MessageBudget::trim);
+}
+
+void MessageBudget::trim()
+{
+	m_scheduled = false;
+
+	int total = 0;
+	foreach(MessagesModel* model, m_models)
+	{
+		total += model->residentCount();
+	}
+	if(total <= m_budget) return;
+
+	m_trims++;
+	foreach(MessagesModel* model, m_models)
+	{
+		// The chat viewed last keeps its window past the rows on screen, the others
+		// keep the rows shown when the chat is opened
+		const int keep = model == m_models.last() ? model->viewportEnd() + m_window : m_window;
+		const int evicted = model->evict(keep);
+		m_evicted += evicted;
+		total -= evicted;
+		if(total <= m_budget) break;
+	}
+}
+
+QVariantMap MessageBudget::stats() const
+{
+	int resident = 0;
+	foreach(MessagesModel* model, m_models)
+	{
+		resident += model->residentCount();
+	}
+
+	return QVariantMap{{"chats", m_models.size()},
+					   {"resident", resident},
+					   {"window", m_window},
+					   {"budget", m_budget},
+					   {"trims", m_trims},
+					   {"evicted", m_evicted}};
+}
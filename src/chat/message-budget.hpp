@@ -0,0 +1,49 @@
+#pragma once
+
+#include <QObject>
+#include <QVariantMap>
+#include <QVector>
+
+class MessagesModel;
+
+// Session wide cap on the number of messages kept in memory across all chats.
+// Each MessagesModel keeps a window of rows past what its view shows. When the
+// total goes over the budget, the chats viewed least recently drop their older
+// rows first. Dropped rows come back through the wakuext_chatMessages cursor
+// when the user scrolls to them.
+// STATUS_MESSAGE_WINDOW and STATUS_MESSAGE_BUDGET override the defaults
+class MessageBudget : public QObject
+{
+	Q_OBJECT
+
+public:
+	static MessageBudget* instance();
+
+	int window() const;
+	void setWindow(int value);
+	int budget() const;
+	void setBudget(int value);
+
+	void add(MessagesModel* model);
+	void touch(MessagesModel* model);
+
+	// Checks the budget once control returns to the event loop
+	void schedule();
+
+	Q_INVOKABLE QVariantMap stats() const;
+
+private:
+	explicit MessageBudget(QObject* parent = nullptr);
+	static MessageBudget* theInstance;
+
+	void trim();
+
+	// Least recently viewed first
+	QVector<MessagesModel*> m_models;
+
+	int m_window;
+	int m_budget;
+	bool m_scheduled;
+	quint64 m_trims;
+	quint64 m_evicted;
+};
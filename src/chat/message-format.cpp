@@ -4,185 +4,339 @@
 #include "contacts-model.hpp"
 #include "content-type.hpp"
 #include "message.hpp"
+#include "parsed-text.hpp"
 #include "settings.hpp"
 #include "utils.hpp"
-#include <QHash>
-#include <QJsonArray>
-#include <QJsonObject>
 #include <QString>
-#include <QStringBuilder>
-#include <QTextDocumentFragment>
-#include <iostream>
-#include <string>
+#include <QStringList>
+#include <QStringView>
+#include <QtAlgorithms>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 using namespace Messages;
 using namespace Messages::Format;
 
-QHash<QString, RenderInlineTypes> renderInlineMap{
-	{"", Empty},
-	{"code", Code},
-	{"emph", Emph},
-	{"strong", Strong},
-	{"strong-emph", StrongEmph},
-	{"link", Link},
-	{"mention", Mention},
-	{"status-tag", StatusTag},
-	{"del", Del},
-};
-
-// See render - inline in status - react / src / status_im / ui / screens / chat / message / message.cljs
-QString renderInline(const QJsonObject& elem, ContactsModel* contactsModel)
+namespace
 {
-	QString value(elem["literal"].toString().toHtmlEscaped().replace("\r\n", "<br />").replace("\n", "<br />"));
-	QString textType = elem["type"].toString();
 
-	if(!renderInlineMap.contains(textType))
-		return " " % value % " ";
+bool needsEscaping(ushort c)
+{
+	return c == '<' || c == '>' || c == '&' || c == '"' || c == '\n' || c == '\r';
+}
 
-	switch(renderInlineMap[textType])
+// First character of [c, end) that appendHtmlEscaped can't copy as is. Eight
+// UTF-16 characters are compared at a time where SSE2 is available
+const QChar* findEscaped(const QChar* c, const QChar* end)
+{
+#ifdef __SSE2__
+	const __m128i lt = _mm_set1_epi16('<');
+	const __m128i gt = _mm_set1_epi16('>');
+	const __m128i amp = _mm_set1_epi16('&');
+	const __m128i quot = _mm_set1_epi16('"');
+	const __m128i lf = _mm_set1_epi16('\n');
+	const __m128i cr = _mm_set1_epi16('\r');
+	for(; end - c >= 8; c += 8)
+	{
+		const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c));
+		const __m128i markup = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi16(chunk, lt), _mm_cmpeq_epi16(chunk, gt)),
+											_mm_or_si128(_mm_cmpeq_epi16(chunk, amp), _mm_cmpeq_epi16(chunk, quot)));
+		const __m128i breaks = _mm_or_si128(_mm_cmpeq_epi16(chunk, lf), _mm_cmpeq_epi16(chunk, cr));
+		const uint mask = _mm_movemask_epi8(_mm_or_si128(markup, breaks));
+		if(mask != 0) return c + qCountTrailingZeroBits(mask) / 2;
+	}
+#endif
+	for(; c != end; ++c)
 	{
-	case Empty: return value;
-	case Code: return "<code>" % value % "</code>";
-	case Emph: return "<em>" % value % "</em>";
-	case Strong: return "<strong>" % value % "</strong>";
-	case StrongEmph: return "<strong><em>" % value % "</em></strong>";
-	case Link: return elem["destination"].toString();
-	case Mention: return "<a href=\"//" % value % "\" class=\"mention\">" % value % "</a>";
-	case StatusTag: return "<a href=\"#" % value % "\" class=\"status-tag\">#" % value % "</a>";
-	case Del: return "<del>" % value % "</del>";
+		if(needsEscaping(c->unicode())) return c;
 	}
-	return "";
+	return end;
 }
 
-// See render - block in status - react / src / status_im / ui / screens / chat / message / message.cljs
-// TODO: make this receive a contacts model and make the functio nstatic and in a message utils class
-
-QString paragraph(const QJsonObject& p, ContactsModel* contactsModel)
+// Plain text the way QTextDocument shows HTML text: runs of whitespace collapse to
+// a single space and a block does not start with one
+class PlainText
 {
-	QStringList inlineResult;
-	foreach(const QJsonValue& child, p["children"].toArray())
+public:
+	explicit PlainText(QString& out)
+		: m_out(out)
+		, m_skipSpace(true)
+	{ }
+
+	void startBlock()
 	{
-		inlineResult << renderInline(child.toObject(), contactsModel);
+		m_skipSpace = true;
 	}
 
-	return QStringLiteral("<p>") % inlineResult.join("") % QStringLiteral("</p>");
-}
+	void append(QStringView text)
+	{
+		const QChar* c = text.data();
+		const QChar* end = c + text.size();
+		for(; c != end; ++c)
+		{
+			if(c->unicode() == QChar::Nbsp)
+			{
+				m_out += QLatin1Char(' ');
+				m_skipSpace = false;
+			}
+			else if(c->isSpace() && c->unicode() != QChar::ParagraphSeparator)
+			{
+				if(!m_skipSpace) m_out += QLatin1Char(' ');
+				m_skipSpace = true;
+			}
+			else
+			{
+				m_out += *c;
+				m_skipSpace = false;
+			}
+		}
+	}
 
-QString blockquote(const QJsonObject& p)
-{
-	return QStringLiteral("<table class=\"blockquote\">") % QStringLiteral("<tr>") %
-		   QStringLiteral("<td class=\"quoteline\" valign=\"middle\"></td>") % QStringLiteral("<td>") %
-		   p["literal"].toString().toHtmlEscaped().split("\n").join("<br/>") % QStringLiteral("</td>") % QStringLiteral("</tr>") %
-		   QStringLiteral("</table>");
-}
+	void space()
+	{
+		if(!m_skipSpace) m_out += QLatin1Char(' ');
+		m_skipSpace = true;
+	}
 
-QString codeblock(const QJsonObject& p)
+private:
+	QString& m_out;
+	bool m_skipSpace;
+};
+
+void appendText(QString& out, QStringView text)
 {
-	return QStringLiteral("<code>") % p["literal"].toString().toHtmlEscaped() % QStringLiteral("</code>");
+	out.append(text.data(), text.size());
 }
 
-QHash<QString, RenderBlockTypes> renderBlockMap{{"paragraph", Paragraph}, {"blockquote", Blockquote}, {"codeblock", Codeblock}};
-
 // See render - inline in status - react / src / status_im / ui / screens / chat / message / message.cljs
-QString renderSimplifiedInline(const QJsonObject& elem, ContactsModel* contactsModel)
+void renderInline(QString& out, const QString& text, const ParsedText::Node& node)
 {
-	QString value(elem["literal"].toString().toHtmlEscaped().replace("\r\n", "<br />").replace("\n", "<br />"));
-	QString textType = elem["type"].toString();
-
-	if(!renderInlineMap.contains(textType))
-		return " " % value % " ";
+	const QStringView literal = ParsedText::literal(text, node);
+	const QLatin1String br("<br />");
 
-	switch(renderInlineMap[textType])
+	switch(node.type)
 	{
-	case Link: return elem["destination"].toString();
-	case Mention: return value;
-	case StatusTag: return "#" % value;
-	default: return " " % QTextDocumentFragment::fromHtml(value).toPlainText() % " ";
+	case ParsedText::Text: appendHtmlEscaped(out, literal, br, true); break;
+	case ParsedText::Code:
+		out += QLatin1String("<code>");
+		appendHtmlEscaped(out, literal, br, true);
+		out += QLatin1String("</code>");
+		break;
+	case ParsedText::Emph:
+		out += QLatin1String("<em>");
+		appendHtmlEscaped(out, literal, br, true);
+		out += QLatin1String("</em>");
+		break;
+	case ParsedText::Strong:
+		out += QLatin1String("<strong>");
+		appendHtmlEscaped(out, literal, br, true);
+		out += QLatin1String("</strong>");
+		break;
+	case ParsedText::StrongEmph:
+		out += QLatin1String("<strong><em>");
+		appendHtmlEscaped(out, literal, br, true);
+		out += QLatin1String("</em></strong>");
+		break;
+	case ParsedText::Link: appendText(out, ParsedText::destination(text, node)); break;
+	case ParsedText::Mention:
+		out += QLatin1String("<a href=\"//");
+		appendHtmlEscaped(out, literal, br, true);
+		out += QLatin1String("\" class=\"mention\">");
+		appendHtmlEscaped(out, literal, br, true);
+		out += QLatin1String("</a>");
+		break;
+	case ParsedText::StatusTag:
+		out += QLatin1String("<a href=\"#");
+		appendHtmlEscaped(out, literal, br, true);
+		out += QLatin1String("\" class=\"status-tag\">#");
+		appendHtmlEscaped(out, literal, br, true);
+		out += QLatin1String("</a>");
+		break;
+	case ParsedText::Del:
+		out += QLatin1String("<del>");
+		appendHtmlEscaped(out, literal, br, true);
+		out += QLatin1String("</del>");
+		break;
+	default:
+		out += QLatin1Char(' ');
+		appendHtmlEscaped(out, literal, br, true);
+		out += QLatin1Char(' ');
 	}
 }
 
-QString simple_paragraph(const QJsonObject& p, ContactsModel* contactsModel)
+// Styled spans are set apart by spaces, and mentions show the public key
+void renderSimplifiedInline(PlainText& out, const QString& text, const ParsedText::Node& node)
 {
-	QStringList inlineResult;
-	foreach(const QJsonValue& child, p["children"].toArray())
+	switch(node.type)
 	{
-		inlineResult << renderSimplifiedInline(child.toObject(), contactsModel);
+	case ParsedText::Link: out.append(ParsedText::destination(text, node)); break;
+	case ParsedText::Mention: out.append(ParsedText::literal(text, node)); break;
+	case ParsedText::StatusTag:
+		out.append(QStringView(u"#"));
+		out.append(ParsedText::literal(text, node));
+		break;
+	default:
+		out.space();
+		out.append(ParsedText::literal(text, node));
+		out.space();
 	}
+}
+
+} // namespace
+
+void Messages::Format::appendHtmlEscaped(QString& out, QStringView text, QLatin1String lineBreak, bool crlf)
+{
+	const QChar* c = text.data();
+	const QChar* end = c + text.size();
+	while(c != end)
+	{
+		// Runs of plain text are copied whole
+		const QChar* escaped = findEscaped(c, end);
+		out.append(c, escaped - c);
+		if(escaped == end) break;
 
-	return inlineResult.join("");
+		c = escaped + 1;
+		switch(escaped->unicode())
+		{
+		case '<': out += QLatin1String("&lt;"); break;
+		case '>': out += QLatin1String("&gt;"); break;
+		case '&': out += QLatin1String("&amp;"); break;
+		case '"': out += QLatin1String("&quot;"); break;
+		case '\n': out += lineBreak; break;
+		case '\r':
+			if(crlf && c != end && *c == QLatin1Char('\n'))
+			{
+				out += lineBreak;
+				++c;
+			}
+			else
+			{
+				out += *escaped;
+			}
+			break;
+		}
+	}
 }
 
 QString Messages::Format::renderSimpleText(Message* message, ContactsModel* contactsModel)
 {
-	QStringList result;
-	foreach(const QJsonValue& pMsg, message->get_parsedText())
-	{
-		const QJsonObject p = pMsg.toObject();
-		QString textType = p["type"].toString();
+	const ParsedText& parsedText = message->get_parsedText();
+	const QString text = parsedText.text();
 
-		if(!renderBlockMap.contains(textType))
-			continue;
+	QString result;
+	result.reserve(text.size() + 16);
+	PlainText out(result);
 
-		if(renderBlockMap[textType] == RenderBlockTypes::Paragraph)
+	for(int i = 0; i < parsedText.count();)
+	{
+		const ParsedText::Node& block = parsedText.node(i++);
+		out.startBlock();
+		if(block.type != ParsedText::Paragraph)
 		{
-			result << QTextDocumentFragment::fromHtml(simple_paragraph(p, contactsModel)).toPlainText();
+			out.append(ParsedText::literal(text, block));
+			continue;
 		}
-		else
+
+		for(const int end = i + block.extra; i < end; i++)
 		{
-			result << QTextDocumentFragment::fromHtml(pMsg["literal"].toString()).toPlainText();
+			renderSimplifiedInline(out, text, parsedText.node(i));
 		}
 	}
-	return result.join("");
+	return result;
 }
 
 QString Messages::Format::renderBlock(Message* message, ContactsModel* contactsModel)
 {
-	QStringList result;
-	foreach(const QJsonValue& pMsg, message->get_parsedText())
-	{
-		const QJsonObject p = pMsg.toObject();
-		QString textType = p["type"].toString();
+	return renderBlock(message->get_parsedText(), contactsModel);
+}
 
-		if(!renderBlockMap.contains(textType))
-			continue;
+QString Messages::Format::renderBlock(const ParsedText& parsedText, ContactsModel* contactsModel)
+{
+	const QString text = parsedText.text();
+
+	QString result;
+	result.reserve(text.size() + 64);
 
-		switch(renderBlockMap[textType])
+	for(int i = 0; i < parsedText.count();)
+	{
+		const ParsedText::Node& block = parsedText.node(i++);
+		switch(block.type)
 		{
-		case RenderBlockTypes::Paragraph: result << paragraph(p, contactsModel); break;
-		case RenderBlockTypes::Blockquote: result << blockquote(p); break;
-		case RenderBlockTypes::Codeblock: result << codeblock(p); break;
+		case ParsedText::Paragraph:
+			result += QLatin1String("<p>");
+			for(const int end = i + block.extra; i < end; i++)
+			{
+				renderInline(result, text, parsedText.node(i));
+			}
+			result += QLatin1String("</p>");
+			break;
+		case ParsedText::Blockquote:
+			result += QLatin1String("<table class=\"blockquote\"><tr><td class=\"quoteline\" valign=\"middle\"></td><td>");
+			appendHtmlEscaped(result, ParsedText::literal(text, block), QLatin1String("<br/>"), false);
+			result += QLatin1String("</td></tr></table>");
+			break;
+		case ParsedText::Codeblock:
+			result += QLatin1String("<code>");
+			appendHtmlEscaped(result, ParsedText::literal(text, block), QLatin1String("\n"), false);
+			result += QLatin1String("</code>");
+			break;
+		default: break;
 		}
 	}
-	return result.join("");
+	return result;
 }
 
 QString Messages::Format::decodeSticker(Message* message)
 {
-	if(message->get_contentType() != ContentType::Sticker)
+	return decodeSticker(message->get_contentType(), message->get_sticker_hash());
+}
+
+QString Messages::Format::decodeSticker(ContentType contentType, const QString& hash)
+{
+	if(contentType != ContentType::Sticker)
 		return "";
 
-	return Utils::decodeHash(message->get_sticker_hash());
+	return Utils::decodeHash(hash);
 }
 
 QString Messages::Format::linkUrls(Message* message)
 {
-	QStringList links;
+	return linkUrls(message->get_parsedText());
+}
 
-	foreach(const QJsonValue& pMsg, message->get_parsedText())
+QString Messages::Format::linkUrls(const ParsedText& parsedText)
+{
+	QStringList links;
+	QString text;
+	for(int i = 0; i < parsedText.count(); i++)
 	{
-		const QJsonObject p = pMsg.toObject();
-		if(p["type"].toString() != QStringLiteral("paragraph"))
-			continue;
-		foreach(const QJsonValue& child, p["children"].toArray())
-		{
-			const QJsonObject c = child.toObject();
-			QString textType = c["type"].toString();
-			QString destination = c["destination"].toString();
+		const ParsedText::Node& node = parsedText.node(i);
+		if(node.type != ParsedText::Link) continue;
 
-			if(textType == "link" && destination.startsWith("http"))
-				links << destination;
-		}
+		// Decoded only for messages with links
+		if(text.isNull()) text = parsedText.text();
+		const QStringView destination = ParsedText::destination(text, node);
+		if(destination.startsWith(QLatin1String("http"))) links << destination.toString();
 	}
 
 	return links.join(" ");
-}
\ No newline at end of file
+}
+
+QStringList Messages::Format::mentions(const ParsedText& parsedText)
+{
+	QStringList result;
+	QString text;
+	for(int i = 0; i < parsedText.count(); i++)
+	{
+		const ParsedText::Node& node = parsedText.node(i);
+		if(node.type != ParsedText::Mention) continue;
+
+		if(text.isNull()) text = parsedText.text();
+		const QString literal = ParsedText::literal(text, node).toString();
+		if(!result.contains(literal)) result << literal;
+	}
+
+	return result;
+}
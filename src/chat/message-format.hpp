@@ -1,40 +1,31 @@
 #pragma once
 
 #include "contacts-model.hpp"
+#include "content-type.hpp"
 #include "message.hpp"
-#include <QHash>
+#include "parsed-text.hpp"
 #include <QString>
+#include <QStringList>
+#include <QStringView>
 
 namespace Messages
 {
 namespace Format
 {
 
-enum RenderInlineTypes
-{
-	Empty,
-	Code,
-	Emph,
-	Strong,
-	StrongEmph,
-	Link,
-	Mention,
-	StatusTag,
-	Del
-};
-
-enum RenderBlockTypes
-{
-	Paragraph,
-	Blockquote,
-	Codeblock
-};
-
 QString renderBlock(Message* message, ContactsModel* contactsModel);
+QString renderBlock(const ParsedText& parsedText, ContactsModel* contactsModel);
 QString renderSimpleText(Message* message, ContactsModel* contactsModel);
 QString linkUrls(Message* message);
+QString linkUrls(const ParsedText& parsedText);
+QStringList mentions(const ParsedText& parsedText);
+
+// Appends text escaped the way QString::toHtmlEscaped does, in a single pass. Newlines
+// become `lineBreak`, and so does "\r\n" when `crlf` is set
+void appendHtmlEscaped(QString& out, QStringView text, QLatin1String lineBreak, bool crlf);
 
 QString decodeSticker(Message* message);
+QString decodeSticker(ContentType contentType, const QString& hash);
 
 } // namespace Format
 } // namespace Messages
\ No newline at end of file
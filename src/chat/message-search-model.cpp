@@ -0,0 +1,76 @@
+#include "message-search-model.hpp"
+#include "message-search.hpp"
+#include <QFutureWatcher>
+
+using namespace Messages;
+
+MessageSearchModel::MessageSearchModel(QObject* parent)
+	: QAbstractListModel(parent)
+{
+	m_limit = 50;
+	m_searching = false;
+
+	QObject::connect(this, &MessageSearchModel::queryChanged, this, &MessageSearchModel::search);
+	QObject::connect(this, &MessageSearchModel::chatIdChanged, this, &MessageSearchModel::search);
+}
+
+QHash<int, QByteArray> MessageSearchModel::roleNames() const
+{
+	QHash<int, QByteArray> roles;
+	roles[Id] = "messageId";
+	roles[ChatId] = "chatId";
+	roles[From] = "from";
+	roles[Clock] = "clock";
+	roles[Text] = "text";
+	return roles;
+}
+
+int MessageSearchModel::rowCount(const QModelIndex& parent = QModelIndex()) const
+{
+	return m_hits.size();
+}
+
+QVariant MessageSearchModel::data(const QModelIndex& index, int role) const
+{
+	if(!index.isValid() || index.row() >= m_hits.size()) return QVariant();
+
+	const SearchIndex::Hit& hit = m_hits[index.row()];
+	switch(role)
+	{
+	case Id: return QVariant(hit.id);
+	case ChatId: return QVariant(hit.chatId);
+	case From: return QVariant(hit.from);
+	case Clock: return QVariant(QString::number(hit.clock));
+	case Text: return QVariant(hit.text);
+	}
+
+	return QVariant();
+}
+
+void MessageSearchModel::search()
+{
+	const quint64 generation = ++m_generation;
+
+	if(m_query.trimmed().isEmpty())
+	{
+		beginResetModel();
+		m_hits.clear();
+		endResetModel();
+		update_searching(false);
+		return;
+	}
+
+	update_searching(true);
+	auto* watcher = new QFutureWatcher<QVector<SearchIndex::Hit>>(this);
+	QObject::connect(watcher, &QFutureWatcher<QVector<SearchIndex::Hit>>::finished, this, [this, watcher, generation]() {
+		if(generation == m_generation)
+		{
+			beginResetModel();
+			m_hits = watcher->result();
+			endResetModel();
+			update_searching(false);
+		}
+		watcher->deleteLater();
+	});
+	watcher->setFuture(MessageSearch::instance()->search(m_query, m_chatId, m_limit));
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "search-index.hpp"
+#include <QAbstractListModel>
+#include <QHash>
+#include <QQmlHelpers>
+#include <QVector>
+
+// Results of a message search, newest first. Setting query runs the search, an
+// empty chatId searches every chat
+class MessageSearchModel : public QAbstractListModel
+{
+	Q_OBJECT
+
+public:
+	enum SearchRoles
+	{
+		Id = Qt::UserRole + 1,
+		ChatId = Qt::UserRole + 2,
+		From = Qt::UserRole + 3,
+		Clock = Qt::UserRole + 4,
+		Text = Qt::UserRole + 5
+	};
+
+	explicit MessageSearchModel(QObject* parent = nullptr);
+
+	QHash<int, QByteArray> roleNames() const;
+	virtual int rowCount(const QModelIndex&) const;
+	virtual QVariant data(const QModelIndex& index, int role) const;
+
+	QML_WRITABLE_PROPERTY(QString, query)
+	QML_WRITABLE_PROPERTY(QString, chatId)
+	QML_WRITABLE_PROPERTY(int, limit)
+	QML_READONLY_PROPERTY(bool, searching)
+
+	Q_INVOKABLE void search();
+
+private:
+	QVector<Messages::SearchIndex::Hit> m_hits;
+
+	// Results of an older query are dropped
+	quint64 m_generation = 0;
+};
@@ -0,0 +1,136 @@
+#include "message-search.hpp"
+#include "constants.hpp"
+#include "content-type.hpp"
+#include "settings.hpp"
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QStringList>
+#include <QtConcurrent/QtConcurrent>
+
+using namespace Messages;
+
+MessageSearch* MessageSearch::theInstance;
+
+MessageSearch* MessageSearch::instance()
+{
+	if(theInstance == 0) theInstance = new MessageSearch();
+	return theInstance;
+}
+
+MessageSearch::MessageSearch(QObject* parent)
+	: QObject(parent)
+	, m_enabled(qEnvironmentVariable("STATUS_SEARCH_INDEX") == "1")
+{
+	m_writer.setMaxThreadCount(1);
+
+	// Pending messages are written out once indexing goes quiet
+	m_flushTimer.setSingleShot(true);
+	m_flushTimer.setInterval(5000);
+	QObject::connect(&m_flushTimer, &QTimer::timeout, this, &MessageSearch::flush);
+
+	QObject::connect(qApp, &QCoreApplication::aboutToQuit, this, [this] {
+		flush();
+		m_writer.waitForDone();
+	});
+}
+
+std::shared_ptr<SearchIndex> MessageSearch::index()
+{
+	const QString publicKey = Settings::instance()->publicKey();
+	if(publicKey.isEmpty() || (!m_enabled && publicKey == m_purgedKey)) return nullptr;
+	if(m_index != nullptr && publicKey == m_publicKey) return m_index;
+
+	const QString account = QCryptographicHash::hash(publicKey.toUtf8(), QCryptographicHash::Sha256).toHex().left(16);
+	const QString path = Constants::applicationPath("/search/" + account);
+	if(!m_enabled)
+	{
+		m_purgedKey = publicKey;
+		QtConcurrent::run(&m_writer, [path] { QDir(path).removeRecursively(); });
+		return nullptr;
+	}
+
+	if(m_index != nullptr) flush();
+
+	m_publicKey = publicKey;
+	m_index = std::make_shared<SearchIndex>(path);
+
+	auto index = m_index;
+	QtConcurrent::run(&m_writer, [index] { index->open(); });
+	return m_index;
+}
+
+void MessageSearch::add(const QVector<Message*>& messages)
+{
+	auto index = this->index();
+	if(index == nullptr) return;
+
+	QVector<SearchIndex::Document> documents;
+	QStringList replaced;
+	foreach(Message* message, messages)
+	{
+		// A replacement drops the text indexed for the message it replaces
+		if(!message->get_replace().isEmpty()) replaced << message->get_replace() << message->get_id();
+
+		const auto contentType = message->get_contentType();
+		if(contentType != ContentType::Message && contentType != ContentType::Emoji) continue;
+		if(message->get_text().isEmpty()) continue;
+
+		documents << SearchIndex::Document{message->get_id(),
+										   message->get_chatId(),
+										   message->get_from(),
+										   message->get_alias() + " " + message->get_ensName(),
+										   message->clockValue(),
+										   message->get_text()};
+	}
+	if(documents.isEmpty() && replaced.isEmpty()) return;
+
+	QtConcurrent::run(&m_writer, [index, documents, replaced] {
+		foreach(const QString& id, replaced)
+		{
+			index->remove(id);
+		}
+		foreach(const SearchIndex::Document& document, documents)
+		{
+			index->add(document);
+		}
+		if(index->pendingCount() >= FlushThreshold)
+		{
+			index->flush();
+			index->compact();
+		}
+	});
+	m_flushTimer.start();
+}
+
+void MessageSearch::flush()
+{
+	if(m_index == nullptr) return;
+
+	auto index = m_index;
+	QtConcurrent::run(&m_writer, [index] {
+		index->flush();
+		index->compact();
+	});
+}
+
+void MessageSearch::clearChat(const QString& chatId, quint64 clock)
+{
+	auto index = this->index();
+	if(index == nullptr) return;
+
+	QtConcurrent::run(&m_writer, [index, chatId, clock] { index->clearChat(chatId, clock); });
+}
+
+QFuture<QVector<SearchIndex::Hit>> MessageSearch::search(const QString& query, const QString& chatId, int limit)
+{
+	auto index = this->index();
+	return QtConcurrent::run([index, query, chatId, limit] {
+		return index != nullptr ? index->search(query, chatId, limit) : QVector<SearchIndex::Hit>();
+	});
+}
+
+QVariantMap MessageSearch::stats() const
+{
+	return m_index != nullptr ? m_index->stats() : QVariantMap{{"enabled", m_enabled}};
+}
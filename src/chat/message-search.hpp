@@ -0,0 +1,48 @@
+#pragma once
+
+#include "message.hpp"
+#include "search-index.hpp"
+#include <QFuture>
+#include <QObject>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVariantMap>
+#include <QVector>
+#include <memory>
+
+// Keeps the search index of the logged in account up to date with the messages
+// the models receive. Indexing and flushes run in order on a single thread,
+// searches run on the global thread pool.
+// The index keeps message text outside of status-go's encrypted database, so it
+// is opt-in: STATUS_SEARCH_INDEX=1 enables it. While it is off, an index left by
+// an earlier run is deleted
+class MessageSearch : public QObject
+{
+	Q_OBJECT
+
+public:
+	static MessageSearch* instance();
+
+	void add(const QVector<Message*>& messages);
+	void clearChat(const QString& chatId, quint64 clock);
+
+	QFuture<QVector<Messages::SearchIndex::Hit>> search(const QString& query, const QString& chatId, int limit);
+
+	Q_INVOKABLE QVariantMap stats() const;
+
+private:
+	explicit MessageSearch(QObject* parent = nullptr);
+	static MessageSearch* theInstance;
+
+	std::shared_ptr<Messages::SearchIndex> index();
+	void flush();
+
+	static const int FlushThreshold = 5000;
+
+	bool m_enabled;
+	QString m_publicKey;
+	QString m_purgedKey;
+	std::shared_ptr<Messages::SearchIndex> m_index;
+	QThreadPool m_writer;
+	QTimer m_flushTimer;
+};
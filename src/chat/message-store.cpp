@@ -0,0 +1,261 @@
+#include "message-store.hpp"
+#include <QQmlApplicationEngine>
+
+using namespace Messages;
+
+int MessageStore::add(const Message* message)
+{
+	int slot;
+	if(m_free.isEmpty())
+	{
+		slot = m_ids.size();
+		m_ids.resize(slot + 1);
+		m_clocks.resize(slot + 1);
+		m_timestamps.resize(slot + 1);
+		m_whisperTimestamps.resize(slot + 1);
+		m_from.resize(slot + 1);
+		m_alias.resize(slot + 1);
+		m_ensName.resize(slot + 1);
+		m_identicon.resize(slot + 1);
+		m_chatId.resize(slot + 1);
+		m_localChatId.resize(slot + 1);
+		m_outgoingStatus.resize(slot + 1);
+		m_contentType.resize(slot + 1);
+		m_messageType.resize(slot + 1);
+		m_flags.resize(slot + 1);
+		m_lineCount.resize(slot + 1);
+		m_text.resize(slot + 1);
+		m_parsedText.resize(slot + 1);
+		m_responseTo.resize(slot + 1);
+		m_image.resize(slot + 1);
+	}
+	else
+	{
+		slot = m_free.takeLast();
+	}
+
+	m_ids[slot] = message->get_id();
+	m_clocks[slot] = message->clockValue();
+	m_timestamps[slot] = message->get_timestamp().toULongLong();
+	m_whisperTimestamps[slot] = message->get_whisperTimestamp().toULongLong();
+	m_from[slot] = intern(message->get_from());
+	m_alias[slot] = intern(message->get_alias());
+	m_ensName[slot] = intern(message->get_ensName());
+	m_identicon[slot] = intern(message->get_identicon());
+	m_chatId[slot] = intern(message->get_chatId());
+	m_localChatId[slot] = intern(message->get_localChatId());
+	m_outgoingStatus[slot] = intern(message->get_outgoingStatus());
+	m_contentType[slot] = message->get_contentType();
+	m_messageType[slot] = message->get_messageType();
+	m_flags[slot] = (message->get_isNew() ? IsNew : 0) | (message->get_rtl() ? Rtl : 0) | (message->get_seen() ? Seen : 0) |
+					(message->get_hasMention() ? HasMention : 0);
+	m_lineCount[slot] = message->get_lineCount();
+	m_text[slot] = message->get_text().toUtf8();
+	m_parsedText[slot] = message->get_parsedText();
+	m_responseTo[slot] = message->get_responseTo();
+	m_image[slot] = message->get_image();
+
+	if(message->get_contentType() == ContentType::Sticker)
+	{
+		m_stickers[slot] = message->get_sticker();
+	}
+
+	return slot;
+}
+
+void MessageStore::remove(int slot)
+{
+	// Release the variable sized data, the fixed size columns are overwritten on reuse
+	m_ids[slot] = QString();
+	m_text[slot] = QByteArray();
+	m_parsedText[slot] = ParsedText();
+	m_responseTo[slot] = QString();
+	m_image[slot] = QString();
+	m_stickers.remove(slot);
+	m_free << slot;
+}
+
+void MessageStore::clear()
+{
+	*this = MessageStore();
+}
+
+int MessageStore::count() const
+{
+	return m_ids.size() - m_free.size();
+}
+
+int MessageStore::slotCount() const
+{
+	return m_ids.size();
+}
+
+quint32 MessageStore::intern(const QString& value)
+{
+	auto it = m_stringKeys.constFind(value);
+	if(it != m_stringKeys.constEnd()) return it.value();
+
+	const quint32 key = m_strings.size();
+	m_strings << value;
+	m_stringKeys.insert(value, key);
+	return key;
+}
+
+const QString& MessageStore::string(quint32 key) const
+{
+	return m_strings[key];
+}
+
+bool MessageStore::findKey(const QString& value, quint32& key) const
+{
+	auto it = m_stringKeys.constFind(value);
+	if(it == m_stringKeys.constEnd()) return false;
+	key = it.value();
+	return true;
+}
+
+QString MessageStore::id(int slot) const
+{
+	return m_ids[slot];
+}
+
+quint64 MessageStore::clock(int slot) const
+{
+	return m_clocks[slot];
+}
+
+quint64 MessageStore::timestamp(int slot) const
+{
+	return m_timestamps[slot];
+}
+
+QString MessageStore::from(int slot) const
+{
+	return string(m_from[slot]);
+}
+
+quint32 MessageStore::fromKey(int slot) const
+{
+	return m_from[slot];
+}
+
+QString MessageStore::ensName(int slot) const
+{
+	return string(m_ensName[slot]);
+}
+
+QString MessageStore::chatId(int slot) const
+{
+	return string(m_chatId[slot]);
+}
+
+ContentType MessageStore::contentType(int slot) const
+{
+	return static_cast<ContentType>(m_contentType[slot]);
+}
+
+QString MessageStore::outgoingStatus(int slot) const
+{
+	return string(m_outgoingStatus[slot]);
+}
+
+void MessageStore::setOutgoingStatus(int slot, const QString& value)
+{
+	m_outgoingStatus[slot] = intern(value);
+}
+
+QString MessageStore::text(int slot) const
+{
+	return QString::fromUtf8(m_text[slot]);
+}
+
+const ParsedText& MessageStore::parsedText(int slot) const
+{
+	return m_parsedText[slot];
+}
+
+QString MessageStore::responseTo(int slot) const
+{
+	return m_responseTo[slot];
+}
+
+QString MessageStore::image(int slot) const
+{
+	return m_image[slot];
+}
+
+QString MessageStore::stickerHash(int slot) const
+{
+	return m_stickers.value(slot).hash;
+}
+
+bool MessageStore::hasMention(int slot) const
+{
+	return m_flags[slot] & HasMention;
+}
+
+QJsonObject MessageStore::toJson(int slot) const
+{
+	QJsonObject obj{{"id", m_ids[slot]},
+					{"alias", string(m_alias[slot])},
+					{"chatId", string(m_chatId[slot])},
+					{"clock", m_clocks[slot] ? QString::number(m_clocks[slot]) : QString()},
+					{"outgoingStatus", string(m_outgoingStatus[slot])},
+					{"contentType", m_contentType[slot]},
+					{"ensName", string(m_ensName[slot])},
+					{"from", string(m_from[slot])},
+					{"identicon", string(m_identicon[slot])},
+					{"lineCount", m_lineCount[slot]},
+					{"localChatId", string(m_localChatId[slot])},
+					{"messageType", m_messageType[slot]},
+					{"new", bool(m_flags[slot] & IsNew)},
+					{"rtl", bool(m_flags[slot] & Rtl)},
+					{"seen", bool(m_flags[slot] & Seen)},
+					{"text", text(slot)},
+					{"timestamp", m_timestamps[slot] ? QString::number(m_timestamps[slot]) : QString()},
+					{"whisperTimestamp", m_whisperTimestamps[slot] ? QString::number(m_whisperTimestamps[slot]) : QString()},
+					{"parsedText", m_parsedText[slot].toJson()},
+					{"responseTo", m_responseTo[slot]},
+					{"image", m_image[slot]}};
+
+	if(m_stickers.contains(slot))
+	{
+		const Sticker sticker = m_stickers.value(slot);
+		obj["sticker"] = QJsonObject{{"hash", sticker.hash}, {"pack", sticker.pack}};
+	}
+
+	return obj;
+}
+
+Message* MessageStore::materialize(int slot, QObject* parent) const
+{
+	Message* message = new Message(toJson(slot), parent);
+	QQmlApplicationEngine::setObjectOwnership(message, QQmlApplicationEngine::CppOwnership);
+	return message;
+}
+
+qint64 MessageStore::memoryUsage() const
+{
+	const qint64 slotSize =
+		sizeof(QString) * 3 + sizeof(QByteArray) + sizeof(ParsedText) + sizeof(quint64) * 3 + sizeof(quint32) * 7 + sizeof(qint8) * 3 + sizeof(int);
+	qint64 total = slotSize * m_ids.capacity();
+
+	auto stringSize = [](const QString& s) { return s.isEmpty() ? 0 : qint64(s.capacity()) * 2 + 24; };
+	for(int i = 0; i < m_ids.size(); i++)
+	{
+		total += stringSize(m_ids[i]) + stringSize(m_responseTo[i]) + stringSize(m_image[i]);
+		total += m_text[i].isEmpty() ? 0 : m_text[i].capacity() + 24;
+		total += m_parsedText[i].memoryUsage();
+	}
+	foreach(const QString& s, m_strings)
+	{
+		total += stringSize(s) * 2;
+	}
+
+	return total;
+}
+
+QVariantMap MessageStore::stats() const
+{
+	return QVariantMap{{"messages", count()}, {"slots", slotCount()}, {"internedStrings", m_strings.size()}, {"bytes", memoryUsage()}};
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "content-type.hpp"
+#include "message-type.hpp"
+#include "message.hpp"
+#include "parsed-text.hpp"
+#include <QByteArray>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QString>
+#include <QVariantMap>
+#include <QVector>
+
+namespace Messages
+{
+
+// Columnar storage for the messages of a chat. Each message is a slot in a set of
+// parallel vectors: clocks and timestamps are kept as numbers, sender data and
+// other repeated strings are interned, and the parsed text is kept as a ParsedText.
+// Slots are reused after a message is removed. Message QObjects are only built
+// when QML asks for one, see materialize()
+class MessageStore
+{
+public:
+	int add(const Message* message);
+	void remove(int slot);
+	void clear();
+
+	int count() const;
+	int slotCount() const;
+
+	QString id(int slot) const;
+	quint64 clock(int slot) const;
+	quint64 timestamp(int slot) const;
+	QString from(int slot) const;
+	quint32 fromKey(int slot) const;
+	QString ensName(int slot) const;
+	QString chatId(int slot) const;
+	ContentType contentType(int slot) const;
+	QString outgoingStatus(int slot) const;
+	void setOutgoingStatus(int slot, const QString& value);
+	QString text(int slot) const;
+	const ParsedText& parsedText(int slot) const;
+	QString responseTo(int slot) const;
+	QString image(int slot) const;
+	QString stickerHash(int slot) const;
+	bool hasMention(int slot) const;
+
+	// Returns false if no message has this value, so it can't match any slot
+	bool findKey(const QString& value, quint32& key) const;
+
+	QJsonObject toJson(int slot) const;
+	Message* materialize(int slot, QObject* parent = nullptr) const;
+
+	// Approximate heap usage of the columns, in bytes
+	qint64 memoryUsage() const;
+	QVariantMap stats() const;
+
+private:
+	enum Flags : quint8
+	{
+		IsNew = 1,
+		Rtl = 2,
+		Seen = 4,
+		HasMention = 8
+	};
+
+	quint32 intern(const QString& value);
+	const QString& string(quint32 key) const;
+
+	QVector<QString> m_ids;
+	QVector<quint64> m_clocks;
+	QVector<quint64> m_timestamps;
+	QVector<quint64> m_whisperTimestamps;
+	QVector<quint32> m_from;
+	QVector<quint32> m_alias;
+	QVector<quint32> m_ensName;
+	QVector<quint32> m_identicon;
+	QVector<quint32> m_chatId;
+	QVector<quint32> m_localChatId;
+	QVector<quint32> m_outgoingStatus;
+	QVector<qint8> m_contentType;
+	QVector<quint8> m_messageType;
+	QVector<quint8> m_flags;
+	QVector<int> m_lineCount;
+	QVector<QByteArray> m_text;
+	QVector<ParsedText> m_parsedText;
+	QVector<QString> m_responseTo;
+	QVector<QString> m_image;
+
+	// Only a few messages are stickers
+	QHash<int, Sticker> m_stickers;
+
+	QVector<int> m_free;
+
+	// Interned strings. Key 0 is the empty string
+	QVector<QString> m_strings{QString()};
+	QHash<QString, quint32> m_stringKeys{{QString(), 0}};
+};
+
+} // namespace Messages
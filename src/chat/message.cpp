@@ -18,28 +18,24 @@ Message::Message(QString id, ContentType contentType, QObject* parent)
 	, m_contentType(contentType)
 { }
 
-QString Message::get_sticker_hash()
+QString Message::get_sticker_hash() const
 {
 	return m_sticker.hash;
 }
 
-bool hasMention(const QJsonArray& parsedText)
+Sticker Message::get_sticker() const
 {
-	foreach(const QJsonValue& value, parsedText)
-	{
-		const QJsonObject obj = value.toObject();
-		if(obj["type"].toString() != "paragraph")
-			continue;
-		foreach(const QJsonValue& child, obj["children"].toArray())
-		{
-			const QJsonObject c = child.toObject();
-			if(c["type"].toString() != "mention")
-				continue;
-			if(c["literal"].toString() == Settings::instance()->publicKey())
-				return true;
-		}
-	}
-	return false;
+	return m_sticker;
+}
+
+quint64 Message::clockValue() const
+{
+	return m_clockValue;
+}
+
+const ParsedText& Message::get_parsedText() const
+{
+	return m_parsedText;
 }
 
 Message::Message(const QJsonValue data, QObject* parent)
@@ -59,13 +55,13 @@ Message::Message(const QJsonValue data, QObject* parent)
 	, m_text(data["text"].toString())
 	, m_timestamp(data["timestamp"].toString())
 	, m_whisperTimestamp(data["whisperTimestamp"].toString())
-	, m_parsedText(data["parsedText"].toArray())
 	, m_responseTo(data["responseTo"].toString())
 	, m_image(data["image"].toString())
 	, m_outgoingStatus(data["outgoingStatus"].toString())
-
+	, m_parsedText(data["parsedText"].toArray())
 {
-	m_hasMention = hasMention(m_parsedText);
+	m_hasMention = m_parsedText.mentions(Settings::instance()->publicKey());
+	m_clockValue = m_clock.toULongLong();
 
 	int contentType = data["contentType"].toInt();
 	if(contentType < ContentType::FetchMoreMessagesButton || contentType > ContentType::Community)
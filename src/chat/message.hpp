@@ -4,6 +4,7 @@
 #include "contact.hpp"
 #include "content-type.hpp"
 #include "message-type.hpp"
+#include "parsed-text.hpp"
 #include <QDebug>
 #include <QJsonArray>
 #include <QJsonObject>
@@ -46,7 +47,6 @@ public:
 	QML_READONLY_PROPERTY(QString, localChatId)
 	QML_READONLY_PROPERTY(MessageType, messageType)
 	QML_READONLY_PROPERTY(bool, isNew)
-	QML_READONLY_PROPERTY(QJsonArray, parsedText)
 	QML_READONLY_PROPERTY(QString, responseTo)
 	//QML_READONLY_PROPERTY(QString, quotedMessage)
 	QML_READONLY_PROPERTY(QString, replace)
@@ -62,9 +62,17 @@ public:
 	QML_READONLY_PROPERTY(Contact*, contact)
 
 public:
-	QString get_sticker_hash();
+	QString get_sticker_hash() const;
+	Sticker get_sticker() const;
+
+	// Numeric value of the clock, used to keep messages in order
+	quint64 clockValue() const;
+
+	const ParsedText& get_parsedText() const;
 
 private:
 	Sticker m_sticker;
+	quint64 m_clockValue = 0;
+	ParsedText m_parsedText;
 };
 } // namespace Messages
\ No newline at end of file
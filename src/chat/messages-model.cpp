@@ -2,8 +2,11 @@
 #include "chat-type.hpp"
 #include "contacts-model.hpp"
 #include "content-type.hpp"
+#include "message-budget.hpp"
 #include "message-format.hpp"
+#include "message-search.hpp"
 #include "message.hpp"
+#include "outgoing-messages.hpp"
 #include "settings.hpp"
 #include "status.hpp"
 #include "utils.hpp"
@@ -17,8 +20,10 @@
 #include <QJsonObject>
 #include <QQmlApplicationEngine>
 #include <QRandomGenerator>
+#include <QSet>
 #include <QString>
 #include <QStringBuilder>
+#include <QTimer>
 #include <QUuid>
 #include <QtConcurrent/QtConcurrent>
 #include <QtGlobal>
@@ -34,9 +39,12 @@ MessagesModel::MessagesModel(QString chatId, ChatType chatType, QObject* parent)
 {
 	qDebug() << "Creating MessageModel for chatId: " << m_chatId;
 	QObject::connect(this, &MessagesModel::messageLoaded, this, QOverload<Message*>::of(&MessagesModel::push));
-	QObject::connect(this, &MessagesModel::reactionLoaded, this, QOverload<QString, QJsonObject>::of(&MessagesModel::push));
-	QObject::connect(Status::instance(), &Status::updateOutgoingStatus, this, &MessagesModel::updateOutgoingStatus);
+	QObject::connect(this, &MessagesModel::reactionsLoaded, this, &MessagesModel::pushReactions);
+	QObject::connect(this, &MessagesModel::contactsChanged, this, [this] {
+		QObject::connect(m_contacts, &ContactsModel::updated, this, &MessagesModel::contactUpdated, Qt::UniqueConnection);
+	});
 	addFakeMessages();
+	MessageBudget::instance()->add(this);
 }
 
 QHash<int, QByteArray> MessagesModel::roleNames() const
@@ -63,12 +71,12 @@ QHash<int, QByteArray> MessagesModel::roleNames() const
 
 int MessagesModel::rowCount(const QModelIndex& parent = QModelIndex()) const
 {
-	return m_messages.size();
+	return m_messages.size() - m_gapSize;
 }
 
-QString sectionIdentifier(const Message* msg)
+QString sectionIdentifier(ContentType contentType, const QString& from)
 {
-	if(msg->get_contentType() == ContentType::Group)
+	if(contentType == ContentType::Group)
 	{
 		// Force section change, because group status messages are sent with the
 		// same fromAuthor, and ends up causing the header to not be shown
@@ -76,7 +84,7 @@ QString sectionIdentifier(const Message* msg)
 	}
 	else
 	{
-		return msg->get_from();
+		return from;
 	}
 }
 
@@ -87,29 +95,30 @@ QVariant MessagesModel::data(const QModelIndex& index, int role) const
 		return QVariant();
 	}
 
-	Message* msg = m_messages[index.row()];
+	const int slot = at(index.row());
+	const auto contentType = m_store.contentType(slot);
 
 	switch(role)
 	{
-	case Id: return QVariant(msg->get_id());
-	case ResponseTo: return QVariant(msg->get_responseTo());
-	case PlainText: return QVariant(msg->get_text());
-	case Contact: return QVariant(msg->get_contentType() != ContentType::ChatIdentifier ? QVariant::fromValue(m_contacts->upsert(msg)) : "");
-	case ContentType: return QVariant(msg->get_contentType());
-	case Clock: return QVariant(msg->get_clock());
-	case ChatId: return QVariant(msg->get_chatId());
-	case Timestamp: return QVariant(msg->get_timestamp());
-	case SectionIdentifier: return QVariant(sectionIdentifier(msg));
-	case ParsedText: return QVariant(Messages::Format::renderBlock(msg, m_contacts));
-	case Sticker: return QVariant(Messages::Format::decodeSticker(msg));
-	case LinkUrls: return QVariant(Messages::Format::linkUrls(msg));
-	case OutgoingStatus: return QVariant(msg->get_outgoingStatus());
-	case Image: return QVariant(msg->get_image());
-	case HasMention: return QVariant(msg->get_hasMention());
-	case EmojiReactions: {
-		QJsonArray emojiReactions = m_emojiReactions[msg->get_id()];
-		return m_emojiReactions.contains(msg->get_id()) ? QVariant(Utils::jsonToStr(emojiReactions)) : QVariant("[]");
+	case Id: return QVariant(m_store.id(slot));
+	case ResponseTo: return QVariant(m_store.responseTo(slot));
+	case PlainText: return QVariant(m_store.text(slot));
+	case Contact: {
+		if(contentType == ContentType::ChatIdentifier) return QVariant("");
+		return QVariant::fromValue(m_contacts->upsert(m_store.from(slot), m_store.ensName(slot)));
 	}
+	case ContentType: return QVariant(contentType);
+	case Clock: return QVariant(m_store.clock(slot) ? QString::number(m_store.clock(slot)) : QString());
+	case ChatId: return QVariant(m_store.chatId(slot));
+	case Timestamp: return QVariant(m_store.timestamp(slot) ? QString::number(m_store.timestamp(slot)) : QString());
+	case SectionIdentifier: return QVariant(sectionIdentifier(contentType, m_store.from(slot)));
+	case ParsedText: return QVariant(rendered(slot).parsedText);
+	case Sticker: return QVariant(rendered(slot).sticker);
+	case LinkUrls: return QVariant(rendered(slot).linkUrls);
+	case OutgoingStatus: return QVariant(m_store.outgoingStatus(slot));
+	case Image: return QVariant(m_store.image(slot));
+	case HasMention: return QVariant(m_store.hasMention(slot));
+	case EmojiReactions: return QVariant(m_reactions.toVariant(m_store.id(slot)));
 	}
 
 	return QVariant();
@@ -117,91 +126,316 @@ QVariant MessagesModel::data(const QModelIndex& index, int role) const
 
 Message* MessagesModel::get(QString messageId) const
 {
-	return m_messageMap[messageId];
+	if(!m_messageMap.contains(messageId)) return nullptr;
+	return materialized(m_messageMap[messageId]);
 }
 
 Message* MessagesModel::get(int row) const
 {
-	if(row < 0 || row > m_messages.size() - 1){
+	if(row < 0 || row > rowCount(QModelIndex()) - 1){
 		return nullptr;
 	}
-	return m_messages[row];
+	return materialized(at(row));
 }
 
-void MessagesModel::push(Message* msg)
+QString MessagesModel::timestampAt(int row) const
+{
+	if(row < 0 || row > rowCount(QModelIndex()) - 1) return QString();
+	const quint64 timestamp = m_store.timestamp(at(row));
+	return timestamp ? QString::number(timestamp) : QString();
+}
+
+QVariantMap MessagesModel::stats() const
+{
+	QVariantMap result = m_store.stats();
+	result["materialized"] = m_materialized.size();
+	result["renderCache"] = QVariantMap{{"hits", m_renderHits}, {"misses", m_renderMisses}, {"invalidations", m_renderInvalidations}};
+	result["evicted"] = m_evicted;
+	result["reactions"] = m_reactions.count();
+	return result;
+}
+
+const MessagesModel::Rendered& MessagesModel::rendered(int slot) const
 {
-	if(msg->get_timestamp().toLongLong() < m_oldestMsgTimestamp)
+	if(slot >= m_rendered.size()) m_rendered.resize(m_store.slotCount());
+
+	Rendered& r = m_rendered[slot];
+	if(r.valid)
 	{
-		update_oldestMsgTimestamp(msg->get_timestamp().toLongLong());
+		m_renderHits++;
+		return r;
 	}
 
-	if(msg->get_replace() != "")
+	m_renderMisses++;
+	const ParsedText& parsedText = m_store.parsedText(slot);
+	r.parsedText = Messages::Format::renderBlock(parsedText, m_contacts);
+	r.linkUrls = Messages::Format::linkUrls(parsedText);
+	r.sticker = Messages::Format::decodeSticker(m_store.contentType(slot), m_store.stickerHash(slot));
+	r.mentions = Messages::Format::mentions(parsedText);
+	r.valid = true;
+
+	foreach(const QString& contactId, r.mentions)
 	{
-		// Delete existing message from UI since it's going to be replaced
-		if(m_messageMap.contains(msg->get_id()))
-		{
-			int row = m_messages.indexOf(m_messageMap[msg->get_id()]);
-			beginRemoveRows(QModelIndex(), row, row);
-			QString id = msg->get_id();
-			delete m_messageMap[id];
-			m_messageMap.remove(id);
-			m_messages.remove(row);
-			endRemoveRows();
-		}
+		m_mentionedBy[contactId] << slot;
+	}
+
+	return r;
+}
+
+void MessagesModel::dropRendered(int slot)
+{
+	if(slot >= m_rendered.size() || !m_rendered[slot].valid) return;
+
+	foreach(const QString& contactId, m_rendered[slot].mentions)
+	{
+		auto it = m_mentionedBy.find(contactId);
+		if(it == m_mentionedBy.end()) continue;
+		it->remove(slot);
+		if(it->isEmpty()) m_mentionedBy.erase(it);
+	}
+	m_rendered[slot] = Rendered();
+}
+
+void MessagesModel::contactUpdated(QString contactId)
+{
+	if(!m_mentionedBy.contains(contactId)) return;
+
+	foreach(int slot, m_mentionedBy.value(contactId))
+	{
+		dropRendered(slot);
+		m_renderInvalidations++;
+
+		QModelIndex idx = createIndex(rowOf(slot), 0);
+		dataChanged(idx, idx, {ParsedText});
 	}
+}
 
-	if(m_messageMap.contains(msg->get_id())) return;
+Message* MessagesModel::materialized(int slot) const
+{
+	// Built the first time get() asks for the row, then kept until the row is released
+	// or the model is cleared: QML may still hold it. Their number is bounded by the
+	// resident rows, which MessageBudget caps across chats
+	Message* msg = m_materialized.value(slot);
+	if(msg) return msg;
 
+	msg = m_store.materialize(slot, const_cast<MessagesModel*>(this));
 	m_contacts->upsert(msg);
+	m_materialized[slot] = msg;
+	return msg;
+}
+
+int MessagesModel::at(int row) const
+{
+	return m_messages[row < m_gapRow ? row : row + m_gapSize];
+}
+
+int MessagesModel::rowOf(int slot) const
+{
+	return m_rows[slot] + m_rowOffset;
+}
+
+int MessagesModel::insertionRow(quint64 clock, int from) const
+{
+	// First row older than clock. Messages with the same clock keep their arrival order
+	auto it = std::partition_point(
+		m_messages.constBegin() + from, m_messages.constEnd(), [this, clock](int slot) { return m_store.clock(slot) >= clock; });
+	return it - m_messages.constBegin();
+}
+
+void MessagesModel::shiftRows(int from, int to, int delta)
+{
+	for(int i = from; i < to; i++)
+	{
+		m_rows[m_messages[i]] += delta;
+	}
+}
+
+void MessagesModel::insertMessages(int row, const QVector<int>& messages)
+{
+	const int count = messages.size();
+	const int size = m_messages.size();
+
+	beginInsertRows(QModelIndex(), row, row + count - 1);
+	if(row < size - row)
+	{
+		// Every row moves down, except the ones before the insertion point
+		m_rowOffset += count;
+		shiftRows(0, row, -count);
+	}
+	else
+	{
+		shiftRows(row, size, count);
+	}
 
-	QQmlApplicationEngine::setObjectOwnership(msg, QQmlApplicationEngine::CppOwnership);
-	msg->setParent(this);
-	beginInsertRows(QModelIndex(), rowCount(), rowCount());
-	m_messageMap[msg->get_id()] = msg;
-	m_messages << msg;
+	m_messages.insert(row, count, -1);
+	for(int i = 0; i < count; i++)
+	{
+		m_messages[row + i] = messages[i];
+		m_rows[messages[i]] = row + i - m_rowOffset;
+	}
 	endInsertRows();
+}
 
-	emit newMessagePushed();
+void MessagesModel::removeMessages(int row, int count)
+{
+	const int size = m_messages.size();
+
+	beginRemoveRows(QModelIndex(), row, row + count - 1);
+	if(row < size - row - count)
+	{
+		m_rowOffset -= count;
+		shiftRows(0, row, count);
+	}
+	else
+	{
+		shiftRows(row + count, size, -count);
+	}
+
+	m_messages.remove(row, count);
+	endRemoveRows();
 }
 
-void MessagesModel::push(QString messageId, QJsonObject newReaction)
+int MessagesModel::store(Message* msg)
 {
-	QtConcurrent::run([=] {
-		QMutexLocker locker(&m_mutex);
-		if(m_emojiReactions.contains(messageId))
+	const int slot = m_store.add(msg);
+	if(slot >= m_rows.size()) m_rows.resize(slot + 1);
+	if(m_store.outgoingStatus(slot) == "sending") OutgoingMessages::instance()->add(m_store.id(slot), this);
+	return slot;
+}
+
+void MessagesModel::release(int slot)
+{
+	m_messageMap.remove(m_store.id(slot));
+	if(m_store.outgoingStatus(slot) == "sending") OutgoingMessages::instance()->remove(m_store.id(slot), this);
+	if(m_materialized.contains(slot)) m_materialized.take(slot)->deleteLater();
+	dropRendered(slot);
+	m_store.remove(slot);
+}
+
+void MessagesModel::push(Message* msg)
+{
+	push(QVector<Message*>{msg});
+}
+
+void MessagesModel::push(QVector<Message*> messages)
+{
+	// Messages already indexed are skipped by the index
+	MessageSearch::instance()->add(messages);
+
+	QVector<Message*> newMessages;
+	QSet<QString> newMessageIds;
+	foreach(Message* msg, messages)
+	{
+		if(msg->get_timestamp().toLongLong() < m_oldestMsgTimestamp)
 		{
-			bool found = false;
-			uint i = -1;
-			bool retraction = false;
-			foreach(const QJsonValue& oldReaction, m_emojiReactions[messageId])
-			{
-				i++;
-				QJsonObject oldReactionObj = oldReaction.toObject();
-				if(oldReactionObj["id"].toString() == newReaction["id"].toString())
-				{
-					found = true;
-					if(newReaction["retracted"].toBool() == true)
-					{
-						retraction = true;
-					}
-					break;
-				}
-			}
-			if(!found)
-			{
-				if(newReaction["retracted"].toBool()) return;
-				m_emojiReactions[messageId] << newReaction;
-			}
-			else if(retraction)
+			update_oldestMsgTimestamp(msg->get_timestamp().toLongLong());
+		}
+
+		if(msg->get_replace() != "")
+		{
+			// Delete existing message from UI since it's going to be replaced
+			if(m_messageMap.contains(msg->get_id()))
 			{
-				m_emojiReactions[messageId].removeAt(i);
+				const int replaced = m_messageMap[msg->get_id()];
+				removeMessages(rowOf(replaced), 1);
+				release(replaced);
 			}
 		}
+
+		if(m_messageMap.contains(msg->get_id()) || newMessageIds.contains(msg->get_id()))
+		{
+			delete msg;
+			continue;
+		}
+
+		m_contacts->upsert(msg);
+
+		newMessageIds << msg->get_id();
+		newMessages << msg;
+	}
+
+	if(newMessages.isEmpty()) return;
+
+	// Rows are kept newest first, matching the bottom-to-top chat view. The fake
+	// messages have no clock, so they stay at the end, next to the oldest message.
+	// Messages that land between the same two rows are inserted as one range
+	auto newerThan = [](const Message* a, const Message* b) { return a->clockValue() > b->clockValue(); };
+	std::stable_sort(newMessages.begin(), newMessages.end(), newerThan);
+
+	// The decoded QObjects are only needed until their data is in the store
+	QVector<int> newSlots;
+	foreach(Message* msg, newMessages)
+	{
+		const int slot = store(msg);
+		m_messageMap[msg->get_id()] = slot;
+		newSlots << slot;
+	}
+	qDeleteAll(newMessages);
+
+	int row = 0;
+	int i = 0;
+	while(i < newSlots.size())
+	{
+		row = insertionRow(m_store.clock(newSlots[i]), row);
+
+		int end = i + 1;
+		if(row == m_messages.size())
+		{
+			end = newSlots.size();
+		}
 		else
 		{
-			m_emojiReactions[messageId] << newReaction;
+			const quint64 next = m_store.clock(m_messages[row]);
+			while(end < newSlots.size() && m_store.clock(newSlots[end]) > next)
+			{
+				end++;
+			}
 		}
-	});
+
+		insertMessages(row, newSlots.mid(i, end - i));
+		row += end - i;
+		i = end;
+	}
+
+	MessageBudget::instance()->schedule();
+	emit newMessagePushed();
+}
+
+void MessagesModel::push(QString messageId, QJsonObject reaction)
+{
+	m_pendingReactions << qMakePair(messageId, reaction);
+	if(m_reactionsScheduled) return;
+	m_reactionsScheduled = true;
+	QTimer::singleShot(0, this, &MessagesModel::applyReactions);
+}
+
+void MessagesModel::pushReactions(QJsonArray reactions)
+{
+	foreach(const QJsonValue& reaction, reactions)
+	{
+		push(reaction["messageId"].toString(), reaction.toObject());
+	}
+}
+
+void MessagesModel::applyReactions()
+{
+	m_reactionsScheduled = false;
+
+	const QString publicKey = Settings::instance()->publicKey();
+	for(const auto& reaction : qAsConst(m_pendingReactions))
+	{
+		if(!m_reactions.apply(reaction.first, reaction.second, publicKey)) continue;
+		// Reactions to messages that aren't loaded yet are kept for when they are
+		if(m_messageMap.contains(reaction.first)) m_changes.add(m_messageMap[reaction.first], {EmojiReactions});
+	}
+	m_pendingReactions.clear();
+
+	flushChanges();
+}
+
+void MessagesModel::flushChanges()
+{
+	m_changes.flush(this, [this](int slot) { return rowOf(slot); });
 }
 
 QString MessagesModel::getCursor()
@@ -216,12 +450,43 @@ void MessagesModel::setCursor(QString value)
 	emit cursorChanged();
 }
 
-void MessagesModel::loadMessages(bool initialLoad)
+void MessagesModel::activate()
+{
+	if(m_activated && !m_prefetched) return;
+	m_activated = true;
+	m_prefetched = false;
+
+	// A prefetch can still be held back on the background lane. Whichever request
+	// runs second finds the first page loaded and does nothing
+	loadMessages(true, RpcExecutor::Interactive);
+	loadReactions(true, RpcExecutor::Interactive);
+}
+
+void MessagesModel::prefetch()
+{
+	if(m_activated) return;
+	m_activated = true;
+	m_prefetched = true;
+	loadMessages(true, RpcExecutor::Background);
+	loadReactions(true, RpcExecutor::Background);
+}
+
+bool MessagesModel::isActivated() const
+{
+	return m_activated;
+}
+
+void MessagesModel::loadMessages(bool initialLoad, RpcExecutor::Priority priority)
 {
 	if(!initialLoad && m_cursor == "") return;
 
-	QtConcurrent::run([=] {
+	Status::instance()->rpcExecutor()->run(priority, [=] {
 		QMutexLocker locker(&m_mutex);
+		if(initialLoad)
+		{
+			if(m_firstPageLoaded) return;
+			m_firstPageLoaded = true;
+		}
 
 		const auto response =
 			Status::instance()->callPrivateRPC("wakuext_chatMessages", QJsonArray{m_chatId, m_cursor, 20}.toVariantList()).toJsonObject();
@@ -246,12 +511,17 @@ void MessagesModel::loadMessages(bool initialLoad)
 	});
 }
 
-void MessagesModel::loadReactions(bool initialLoad)
+void MessagesModel::loadReactions(bool initialLoad, RpcExecutor::Priority priority)
 {
 	if(!initialLoad && m_reactionsCursor == "") return;
 
-	QtConcurrent::run([=] {
+	Status::instance()->rpcExecutor()->run(priority, [=] {
 		QMutexLocker locker(&m_mutex);
+		if(initialLoad)
+		{
+			if(m_firstReactionsLoaded) return;
+			m_firstReactionsLoaded = true;
+		}
 
 		const auto response = Status::instance()
 								  ->callPrivateRPC("wakuext_emojiReactionsByChatID", QJsonArray{m_chatId, m_reactionsCursor, 20}.toVariantList())
@@ -259,123 +529,201 @@ void MessagesModel::loadReactions(bool initialLoad)
 		m_reactionsCursor = response["result"]["cursor"].toString();
 
 		QJsonArray reactions = response["result"].toArray();
-		if(reactions.count() > 0)
-		{
-			foreach(const QJsonValue& reaction, reactions)
-			{
-				const QJsonObject r = reaction.toObject();
-				emit reactionLoaded(r["messageId"].toString(), r);
-			}
-		}
+		if(reactions.count() > 0) emit reactionsLoaded(reactions);
 	});
 }
 
 void MessagesModel::toggleReaction(QString messageId, int emojiId)
 {
-	if(!m_emojiReactions.contains(messageId))
+	const QPair<QString, int> key(messageId, emojiId);
+	if(m_reactionsInFlight.contains(key)) return;
+	m_reactionsInFlight << key;
+
+	auto onResponse = [this, key](QJsonObject response) {
+		// Applied before the signal goes out, so the next toggle finds the reaction. The
+		// copy the signal brings back is skipped by the index
+		const QJsonObject result = response["result"].toObject();
+		pushReactions(result["emojiReactions"].toArray());
+		applyReactions();
+		m_reactionsInFlight.remove(key);
+		Status::instance()->emitMessageSignal(result);
+	};
+
+	const QString reactionId = m_reactions.mine(messageId, emojiId);
+	if(reactionId.isEmpty())
 	{
-		const auto response =
-			Status::instance()->callPrivateRPC("wakuext_sendEmojiReaction", QJsonArray{m_chatId, messageId, emojiId}.toVariantList()).toJsonObject();
-		Status::instance()->emitMessageSignal(response["result"].toObject());
+		Status::instance()->callPrivateRPCAsync(
+			"wakuext_sendEmojiReaction", QJsonArray{m_chatId, messageId, emojiId}.toVariantList(), this, onResponse);
 		return;
 	}
 
-	bool exists = false;
-	int i = -1;
-	QString reactionId("");
-	foreach(const QJsonValue& reaction, m_emojiReactions[messageId])
-	{
-		i++;
-		const QJsonObject r = reaction.toObject();
-		if(r["emojiId"].toInt() == emojiId && r["from"] == Settings::instance()->publicKey())
-		{
-			exists = true;
-			reactionId = r["id"].toString();
-			break;
-		}
-	}
-	if(exists)
-	{
-		m_emojiReactions[messageId].removeAt(i);
-		const auto response =
-			Status::instance()->callPrivateRPC("wakuext_sendEmojiReactionRetraction", QJsonArray{reactionId}.toVariantList()).toJsonObject();
-		Status::instance()->emitMessageSignal(response["result"].toObject());
-	}
-	else
+	if(m_reactions.remove(messageId, reactionId) && m_messageMap.contains(messageId))
 	{
-		const auto response =
-			Status::instance()->callPrivateRPC("wakuext_sendEmojiReaction", QJsonArray{m_chatId, messageId, emojiId}.toVariantList()).toJsonObject();
-		Status::instance()->emitMessageSignal(response["result"].toObject());
+		m_changes.add(m_messageMap[messageId], {EmojiReactions});
+		flushChanges();
 	}
+	Status::instance()->callPrivateRPCAsync(
+		"wakuext_sendEmojiReactionRetraction", QJsonArray{reactionId}.toVariantList(), this, onResponse);
 }
 
 void MessagesModel::addFakeMessages()
 {
 	if(m_chatType != ChatType::Profile && m_chatType != ChatType::Timeline)
 	{
-		Message* fetchMoreMessages = new Message("fetchMoreMessages", ContentType::FetchMoreMessagesButton, this);
-		QQmlApplicationEngine::setObjectOwnership(fetchMoreMessages, QQmlApplicationEngine::CppOwnership);
-
-		Message* chatIdentifier = new Message("chatIdentifier", ContentType::ChatIdentifier, this);
-		QQmlApplicationEngine::setObjectOwnership(chatIdentifier, QQmlApplicationEngine::CppOwnership);
-
-		beginInsertRows(QModelIndex(), rowCount(), rowCount());
-		m_messages << fetchMoreMessages;
-		m_messages << chatIdentifier;
-		endInsertRows();
+		Message fetchMoreMessages("fetchMoreMessages", ContentType::FetchMoreMessagesButton, nullptr);
+		Message chatIdentifier("chatIdentifier", ContentType::ChatIdentifier, nullptr);
+		insertMessages(m_messages.size(), {store(&fetchMoreMessages), store(&chatIdentifier)});
+		m_fakeRows = 2;
 	}
 }
 
 void MessagesModel::clear()
 {
 	beginResetModel();
+	// QML may still hold on to messages it got from get() until the reset is processed
+	foreach(Message* msg, m_materialized)
+	{
+		msg->deleteLater();
+	}
+	m_materialized.clear();
+	m_rendered.clear();
+	m_mentionedBy.clear();
+	m_reactions.clear();
+	OutgoingMessages::instance()->remove(this);
+	m_store.clear();
 	m_messages.clear();
+	m_messageMap.clear();
+	m_rows.clear();
+	m_rowOffset = 0;
 	addFakeMessages();
 	endResetModel();
 }
 
+void MessagesModel::setOutgoingStatus(int slot, const QString& status)
+{
+	m_store.setOutgoingStatus(slot, status);
+	if(status == "sending")
+		OutgoingMessages::instance()->add(m_store.id(slot), this);
+	else
+		OutgoingMessages::instance()->remove(m_store.id(slot), this);
+	if(m_materialized.contains(slot)) m_materialized[slot]->update_outgoingStatus(status);
+	m_changes.add(slot, {OutgoingStatus});
+}
+
 void MessagesModel::updateOutgoingStatus(QVector<QString> messageIds, bool sent)
 {
 	foreach(const QString& messageId, messageIds)
 	{
 		if(!m_messageMap.contains(messageId)) continue;
-		m_messageMap[messageId]->update_outgoingStatus(sent ? "sent" : "not-sent");
-		Status::instance()
-			->callPrivateRPC("wakuext_updateMessageOutgoingStatus",
-							 QJsonArray{messageId, m_messageMap[messageId]->get_outgoingStatus()}.toVariantList())
-			.toJsonObject();
-		int index = m_messages.indexOf(m_messageMap[messageId]);
-		QModelIndex idx = createIndex(index, 0);
-		dataChanged(idx, idx);
+		setOutgoingStatus(m_messageMap[messageId], sent ? "sent" : "not-sent");
 	}
+	flushChanges();
 }
 
 void MessagesModel::resend(QString messageId)
 {
 	if(!m_messageMap.contains(messageId)) return;
 
-	m_messageMap[messageId]->update_outgoingStatus("sending");
-	Status::instance()->callPrivateRPC("wakuext_updateMessageOutgoingStatus", QJsonArray{messageId, QStringLiteral("sending")}.toVariantList());
-	Status::instance()->callPrivateRPC("wakuext_reSendChatMessage", QJsonArray{messageId}.toVariantList());
+	Status::instance()->rpcExecutor()->run([messageId] {
+		Status::instance()->callPrivateRPC("wakuext_updateMessageOutgoingStatus", QJsonArray{messageId, QStringLiteral("sending")}.toVariantList());
+		Status::instance()->callPrivateRPC("wakuext_reSendChatMessage", QJsonArray{messageId}.toVariantList());
+	});
 
-	int index = m_messages.indexOf(m_messageMap[messageId]);
-	QModelIndex idx = createIndex(index, 0);
-	dataChanged(idx, idx);
+	setOutgoingStatus(m_messageMap[messageId], "sending");
+	flushChanges();
 }
 
 void MessagesModel::removeFrom(QString contactId)
 {
-	foreach(Message* message, m_messages)
+	quint32 from;
+	if(!m_store.findKey(contactId, from)) return;
+
+	// Single compacting pass: kept messages are moved down over the removed ones,
+	// and each run of consecutive removals is announced as one range. Until the
+	// pass is done, the removed slots form a gap in m_messages that at() skips
+	const int size = m_messages.size();
+	int write = 0;
+	int read = 0;
+	while(read < size)
 	{
-		if(message->get_from() != contactId) continue;
-		QString id = message->get_id();
-		int index = m_messages.indexOf(m_messageMap[id]);
-		if(index == -1) continue;
-
-		beginRemoveRows(QModelIndex(), index, index);
-		delete m_messageMap[id];
-		m_messageMap.remove(id);
-		m_messages.remove(index);
+		const int slot = m_messages[read];
+		if(m_store.fromKey(slot) != from)
+		{
+			if(write != read)
+			{
+				m_messages[write] = slot;
+				m_rows[slot] = write - m_rowOffset;
+			}
+			m_gapRow = ++write;
+			read++;
+			continue;
+		}
+
+		int end = read;
+		while(end < size && m_store.fromKey(m_messages[end]) == from)
+		{
+			end++;
+		}
+
+		const QVector<int> removed = m_messages.mid(read, end - read);
+		beginRemoveRows(QModelIndex(), write, write + removed.size() - 1);
+		m_gapSize = end - write;
 		endRemoveRows();
+
+		foreach(int removedSlot, removed)
+		{
+			release(removedSlot);
+		}
+		read = end;
+	}
+
+	m_messages.resize(write);
+	m_gapRow = 0;
+	m_gapSize = 0;
+}
+
+int MessagesModel::residentCount() const
+{
+	return m_store.count() - m_fakeRows;
+}
+
+int MessagesModel::viewportEnd() const
+{
+	return m_viewportEnd;
+}
+
+void MessagesModel::setViewportEnd(int lastRow)
+{
+	m_viewportEnd = lastRow;
+	MessageBudget::instance()->touch(this);
+	MessageBudget::instance()->schedule();
+}
+
+int MessagesModel::evict(int keepRows)
+{
+	// The fake rows stay after the oldest message
+	const int first = std::max(1, keepRows);
+	const int end = m_messages.size() - m_fakeRows;
+	if(first >= end) return 0;
+
+	// A page being loaded would overwrite the cursor. Try again on the next trim
+	if(!m_mutex.tryLock()) return 0;
+
+	const QVector<int> evicted = m_messages.mid(first, end - first);
+	removeMessages(first, evicted.size());
+	foreach(int slot, evicted)
+	{
+		release(slot);
 	}
-}
\ No newline at end of file
+
+	// status-go cursors are the zero padded clock followed by the message id, and
+	// include the message they point to. The oldest resident message comes back
+	// with the page and is dropped by push() as a duplicate
+	const int oldest = m_messages[first - 1];
+	m_cursor = QString::number(m_store.clock(oldest)).rightJustified(64, '0') + m_store.id(oldest);
+	m_mutex.unlock();
+	emit cursorChanged();
+
+	m_evicted += evicted.size();
+	return evicted.size();
+}
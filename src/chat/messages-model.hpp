@@ -2,12 +2,21 @@
 
 #include "chat-type.hpp"
 #include "contacts-model.hpp"
+#include "message-store.hpp"
 #include "message.hpp"
+#include "reaction-index.hpp"
+#include "role-changes.hpp"
+#include "rpc-executor.hpp"
 #include <QAbstractListModel>
 #include <QDebug>
 #include <QHash>
+#include <QJsonArray>
 #include <QMutex>
+#include <QPair>
 #include <QQmlHelpers>
+#include <QSet>
+#include <QStringList>
+#include <QVariantMap>
 #include <QVector>
 
 using namespace Messages;
@@ -47,14 +56,25 @@ public:
 	virtual int rowCount(const QModelIndex&) const;
 	virtual QVariant data(const QModelIndex& index, int role) const;
 	void push(Message* message);
+	void push(QVector<Message*> messages);
 	void push(QString messageId, QJsonObject reaction);
 
 	Q_INVOKABLE Message* get(QString messageId) const;
 	Q_INVOKABLE Message* get(int row) const;
+	// Same as get(row).timestamp, without materializing the message
+	Q_INVOKABLE QString timestampAt(int row) const;
+	// Last (oldest) row shown by the chat view. Rows past the window after it can be
+	// evicted, the newer rows before it are always kept
+	Q_INVOKABLE void setViewportEnd(int lastRow);
 	Q_INVOKABLE void toggleReaction(QString messageId, int emojiId);
-	Q_INVOKABLE void updateOutgoingStatus(QVector<QString> messageIds, bool sent);
+	// Called by OutgoingMessages, which also saves the new status
+	void updateOutgoingStatus(QVector<QString> messageIds, bool sent);
 	Q_INVOKABLE void resend(QString messageId);
 
+	// Store size, number of messages currently materialized as QObjects and
+	// render cache hits and misses
+	Q_INVOKABLE QVariantMap stats() const;
+
 	QML_WRITABLE_PROPERTY(ContactsModel*, contacts)
 	QML_READONLY_PROPERTY(qint64, oldestMsgTimestamp)
 
@@ -66,23 +86,79 @@ public:
 	void setCursor(QString value);
 
 public:
-	void loadMessages(bool initialLoad = true);
-	void loadReactions(bool initialLoad = true);
+	void loadMessages(bool initialLoad = true, RpcExecutor::Priority priority = RpcExecutor::Normal);
+	void loadReactions(bool initialLoad = true, RpcExecutor::Priority priority = RpcExecutor::Normal);
+
+	// Loads the first page of messages and reactions, once. History is requested
+	// when a chat is first shown, or earlier by the prefetcher on the background lane.
+	// Showing a chat whose prefetch hasn't run yet requests it again on the
+	// interactive lane, and the first of the two to run loads the page
+	Q_INVOKABLE void activate();
+	void prefetch();
+	bool isActivated() const;
 	void clear();
 	void removeFrom(QString contactId);
 
+	int residentCount() const;
+	int viewportEnd() const;
+	// Drops the messages older than the first keepRows rows, and moves the cursor
+	// back so they are loaded again. Returns the number of messages dropped
+	int evict(int keepRows);
+
 signals:
 	void statusUpdateLoaded(Message* message);
 	void messageLoaded(Message* message);
 	void messagesLoaded();
-	void reactionLoaded(QString messageId, QJsonObject reaction);
+	void reactionsLoaded(QJsonArray reactions);
 	void newMessagePushed();
 	void cursorChanged();
 
 private:
-	QVector<Message*> m_messages;
-	QHash<QString, Message*> m_messageMap;
-	QHash<QString, QJsonArray> m_emojiReactions;
+	MessageStore m_store;
+
+	// Store slot of each row, and of each message id
+	QVector<int> m_messages;
+	QHash<QString, int> m_messageMap;
+
+	// Row of each store slot, relative to m_rowOffset. Inserting or removing
+	// rows renumbers only the shorter side of the change
+	QVector<int> m_rows;
+	int m_rowOffset = 0;
+
+	// QObjects handed out by get(), by slot. Deleted with their row, see release()
+	mutable QHash<int, Message*> m_materialized;
+
+	// Output of the formatting roles, by slot. Filled the first time a row is
+	// shown, and dropped when a contact it mentions changes
+	struct Rendered
+	{
+		QString parsedText;
+		QString linkUrls;
+		QString sticker;
+		QStringList mentions;
+		bool valid = false;
+	};
+	mutable QVector<Rendered> m_rendered;
+	mutable QHash<QString, QSet<int>> m_mentionedBy;
+	mutable quint64 m_renderHits = 0;
+	mutable quint64 m_renderMisses = 0;
+	quint64 m_renderInvalidations = 0;
+
+	// Rows already dropped from m_messages but not compacted yet, while removeFrom runs
+	int m_gapRow = 0;
+	int m_gapSize = 0;
+
+	// Reactions are applied on the UI thread, in batches, see applyReactions()
+	ReactionIndex m_reactions;
+	QVector<QPair<QString, QJsonObject>> m_pendingReactions;
+	bool m_reactionsScheduled = false;
+	// (message, emoji) toggles waiting for status-go. Further toggles of the same
+	// emoji are ignored until then, as the index doesn't have the reaction yet
+	QSet<QPair<QString, int>> m_reactionsInFlight;
+
+	// Roles changed per slot, announced by flushChanges()
+	RoleChanges<int> m_changes;
+
 	QString m_chatId;
 	ChatType m_chatType;
 
@@ -90,5 +166,34 @@ private:
 	QString m_reactionsCursor;
 	QMutex m_mutex;
 
+	int m_fakeRows = 0;
+	bool m_activated = false;
+	bool m_prefetched = false;
+	// Set by the job that loaded the first page, under m_mutex
+	bool m_firstPageLoaded = false;
+	bool m_firstReactionsLoaded = false;
+	int m_viewportEnd = 0;
+	quint64 m_evicted = 0;
+
 	void addFakeMessages();
+
+	int at(int row) const;
+	int rowOf(int slot) const;
+	int insertionRow(quint64 clock, int from) const;
+	void insertMessages(int row, const QVector<int>& messages);
+	void removeMessages(int row, int count);
+	void shiftRows(int from, int to, int delta);
+
+	int store(Message* msg);
+	void release(int slot);
+	Message* materialized(int slot) const;
+	void setOutgoingStatus(int slot, const QString& status);
+
+	const Rendered& rendered(int slot) const;
+	void dropRendered(int slot);
+
+	void pushReactions(QJsonArray reactions);
+	void applyReactions();
+	void flushChanges();
+	void contactUpdated(QString contactId);
 };
\ No newline at end of file
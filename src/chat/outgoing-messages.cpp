@@ -0,0 +1,85 @@
+#include "outgoing-messages.hpp"
+#include "messages-model.hpp"
+#include "status.hpp"
+#include <QHash>
+#include <QJsonArray>
+#include <QVector>
+
+OutgoingMessages* OutgoingMessages::theInstance;
+
+OutgoingMessages* OutgoingMessages::instance()
+{
+	if(theInstance == 0) theInstance = new OutgoingMessages();
+	return theInstance;
+}
+
+OutgoingMessages::OutgoingMessages(QObject* parent)
+	: QObject(parent)
+{
+	QObject::connect(Status::instance(), &Status::updateOutgoingStatus, this, &OutgoingMessages::update);
+}
+
+void OutgoingMessages::add(const QString& messageId, MessagesModel* model)
+{
+	if(m_owners.contains(messageId, model)) return;
+	QObject::connect(model, &QObject::destroyed, this, &OutgoingMessages::removeModel, Qt::UniqueConnection);
+	m_owners.insert(messageId, model);
+}
+
+void OutgoingMessages::remove(const QString& messageId, MessagesModel* model)
+{
+	m_owners.remove(messageId, model);
+}
+
+void OutgoingMessages::remove(MessagesModel* model)
+{
+	removeModel(model);
+}
+
+int OutgoingMessages::count() const
+{
+	return m_owners.size();
+}
+
+void OutgoingMessages::removeModel(QObject* model)
+{
+	for(auto it = m_owners.begin(); it != m_owners.end();)
+	{
+		if(it.value() == model)
+			it = m_owners.erase(it);
+		else
+			++it;
+	}
+}
+
+void OutgoingMessages::update(QVector<QString> messageIds, bool sent)
+{
+	QHash<MessagesModel*, QVector<QString>> byModel;
+	QVector<QString> owned;
+	foreach(const QString& messageId, messageIds)
+	{
+		const QList<MessagesModel*> models = m_owners.values(messageId);
+		if(models.isEmpty()) continue;
+
+		owned << messageId;
+		foreach(MessagesModel* model, models)
+		{
+			byModel[model] << messageId;
+		}
+	}
+	if(owned.isEmpty()) return;
+
+	// One JSON-RPC batch per signal
+	const QString status = sent ? "sent" : "not-sent";
+	QVector<RpcCall> calls;
+	foreach(const QString& messageId, owned)
+	{
+		calls << RpcCall{"wakuext_updateMessageOutgoingStatus", QJsonArray{messageId, status}.toVariantList()};
+	}
+	Status::instance()->rpcExecutor()->run([calls] { Status::instance()->callPrivateRPCBatch(calls); });
+
+	for(auto it = byModel.constBegin(); it != byModel.constEnd(); ++it)
+	{
+		it.key()->updateOutgoingStatus(it.value(), sent);
+	}
+}
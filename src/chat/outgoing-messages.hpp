@@ -0,0 +1,34 @@
+#pragma once
+
+#include <QMultiHash>
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+class MessagesModel;
+
+// Messages waiting for an envelope.sent or envelope.expired signal, and the
+// models that show them. A signal only reaches the models owning its ids, and
+// the new statuses are saved in a single background task
+class OutgoingMessages : public QObject
+{
+	Q_OBJECT
+
+public:
+	static OutgoingMessages* instance();
+
+	void add(const QString& messageId, MessagesModel* model);
+	void remove(const QString& messageId, MessagesModel* model);
+	void remove(MessagesModel* model);
+	int count() const;
+
+private:
+	explicit OutgoingMessages(QObject* parent = nullptr);
+	static OutgoingMessages* theInstance;
+
+	void update(QVector<QString> messageIds, bool sent);
+	void removeModel(QObject* model);
+
+	// A status update can be in both its profile chat and the timeline
+	QMultiHash<QString, MessagesModel*> m_owners;
+};
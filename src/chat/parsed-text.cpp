@@ -0,0 +1,176 @@
+#include "parsed-text.hpp"
+#include <QHash>
+#include <QJsonObject>
+#include <QVector>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+using namespace Messages;
+
+namespace
+{
+
+const QHash<QString, ParsedText::NodeType> blockTypes{
+	{"paragraph", ParsedText::Paragraph}, {"blockquote", ParsedText::Blockquote}, {"codeblock", ParsedText::Codeblock}};
+
+const QHash<QString, ParsedText::NodeType> inlineTypes{
+	{"", ParsedText::Text},
+	{"code", ParsedText::Code},
+	{"emph", ParsedText::Emph},
+	{"strong", ParsedText::Strong},
+	{"strong-emph", ParsedText::StrongEmph},
+	{"link", ParsedText::Link},
+	{"mention", ParsedText::Mention},
+	{"status-tag", ParsedText::StatusTag},
+	{"del", ParsedText::Del},
+};
+
+// The node count comes first, and keeps the node table aligned
+const int HeaderSize = sizeof(quint32);
+
+} // namespace
+
+ParsedText::ParsedText(const QJsonArray& parsedText)
+{
+	QVector<Node> nodes;
+	QString text;
+
+	auto append = [&text](const QString& value) {
+		const quint32 offset = text.size();
+		text += value;
+		return offset;
+	};
+
+	foreach(const QJsonValue& blockJson, parsedText)
+	{
+		// Blocks of other types are not rendered
+		const NodeType type = blockTypes.value(blockJson["type"].toString(), Unknown);
+		if(type == Unknown) continue;
+
+		const QString literal = blockJson["literal"].toString();
+		nodes << Node{append(literal), quint32(literal.size()), 0, type};
+		if(type != Paragraph) continue;
+
+		const int block = nodes.size() - 1;
+		foreach(const QJsonValue& child, blockJson["children"].toArray())
+		{
+			if(nodes[block].extra == std::numeric_limits<quint16>::max()) break;
+			nodes[block].extra++;
+
+			const QString childLiteral = child["literal"].toString();
+			Node node{append(childLiteral), quint32(childLiteral.size()), 0, inlineTypes.value(child["type"].toString(), Unknown)};
+			if(node.type == Link)
+			{
+				const QString destination = child["destination"].toString().left(std::numeric_limits<quint16>::max());
+				append(destination);
+				node.extra = destination.size();
+			}
+			nodes << node;
+		}
+	}
+
+	if(nodes.isEmpty()) return;
+
+	const QByteArray utf8 = text.toUtf8();
+	const int nodesSize = nodes.size() * sizeof(Node);
+	m_data.resize(HeaderSize + nodesSize + utf8.size());
+
+	const quint32 count = nodes.size();
+	memcpy(m_data.data(), &count, HeaderSize);
+	memcpy(m_data.data() + HeaderSize, nodes.constData(), nodesSize);
+	memcpy(m_data.data() + HeaderSize + nodesSize, utf8.constData(), utf8.size());
+}
+
+bool ParsedText::isEmpty() const
+{
+	return m_data.isEmpty();
+}
+
+int ParsedText::count() const
+{
+	if(m_data.isEmpty()) return 0;
+
+	quint32 count;
+	memcpy(&count, m_data.constData(), HeaderSize);
+	return count;
+}
+
+const ParsedText::Node* ParsedText::nodes() const
+{
+	return reinterpret_cast<const Node*>(m_data.constData() + HeaderSize);
+}
+
+const ParsedText::Node& ParsedText::node(int i) const
+{
+	return nodes()[i];
+}
+
+int ParsedText::textOffset() const
+{
+	return HeaderSize + count() * sizeof(Node);
+}
+
+QString ParsedText::text() const
+{
+	if(m_data.isEmpty()) return QString();
+
+	const int offset = textOffset();
+	return QString::fromUtf8(m_data.constData() + offset, m_data.size() - offset);
+}
+
+QStringView ParsedText::literal(const QString& text, const Node& node)
+{
+	return QStringView(text).mid(node.offset, node.size);
+}
+
+QStringView ParsedText::destination(const QString& text, const Node& node)
+{
+	if(node.type != Link) return QStringView();
+	return QStringView(text).mid(node.offset + node.size, node.extra);
+}
+
+bool ParsedText::mentions(const QString& publicKey) const
+{
+	const int nodeCount = count();
+	const Node* first = nodes();
+	if(std::none_of(first, first + nodeCount, [](const Node& node) { return node.type == Mention; })) return false;
+
+	const QString content = text();
+	return std::any_of(first, first + nodeCount, [&content, &publicKey](const Node& node) {
+		return node.type == Mention && literal(content, node) == publicKey;
+	});
+}
+
+QJsonArray ParsedText::toJson() const
+{
+	static const char* typeNames[] = {
+		"paragraph", "blockquote", "codeblock", "", "code", "emph", "strong", "strong-emph", "link", "mention", "status-tag", "del", "unknown"};
+
+	const QString content = text();
+	QJsonArray result;
+	for(int i = 0; i < count();)
+	{
+		const Node& block = node(i++);
+		QJsonObject blockJson{{"type", typeNames[block.type]}, {"literal", literal(content, block).toString()}};
+		if(block.type == Paragraph)
+		{
+			QJsonArray children;
+			for(const int end = i + block.extra; i < end; i++)
+			{
+				const Node& child = node(i);
+				QJsonObject childJson{{"type", typeNames[child.type]}, {"literal", literal(content, child).toString()}};
+				if(child.type == Link) childJson["destination"] = destination(content, child).toString();
+				children << childJson;
+			}
+			blockJson["children"] = children;
+		}
+		result << blockJson;
+	}
+	return result;
+}
+
+qint64 ParsedText::memoryUsage() const
+{
+	return m_data.isEmpty() ? 0 : m_data.capacity() + 24;
+}
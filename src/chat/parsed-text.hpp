@@ -0,0 +1,68 @@
+#pragma once
+
+#include <QByteArray>
+#include <QJsonArray>
+#include <QString>
+#include <QStringView>
+
+namespace Messages
+{
+
+// The parsedText of a status-go message, decoded once into typed nodes. Blocks are
+// stored in order, each followed by its inline children. Everything lives in one
+// implicitly shared buffer: the node table, then the literals as UTF-8. Node
+// offsets index into the UTF-16 text returned by text()
+class ParsedText
+{
+public:
+	enum NodeType : quint8
+	{
+		Paragraph,
+		Blockquote,
+		Codeblock,
+		Text,
+		Code,
+		Emph,
+		Strong,
+		StrongEmph,
+		Link,
+		Mention,
+		StatusTag,
+		Del,
+		Unknown
+	};
+
+	struct Node
+	{
+		quint32 offset;
+		quint32 size;
+		// Children of a paragraph, or length of a link destination, which follows its literal
+		quint16 extra;
+		NodeType type;
+	};
+
+	ParsedText() = default;
+	explicit ParsedText(const QJsonArray& parsedText);
+
+	bool isEmpty() const;
+	int count() const;
+	const Node& node(int i) const;
+
+	// The literals of every node, decoded in one go
+	QString text() const;
+	static QStringView literal(const QString& text, const Node& node);
+	static QStringView destination(const QString& text, const Node& node);
+
+	bool mentions(const QString& publicKey) const;
+
+	QJsonArray toJson() const;
+	qint64 memoryUsage() const;
+
+private:
+	const Node* nodes() const;
+	int textOffset() const;
+
+	QByteArray m_data;
+};
+
+} // namespace Messages
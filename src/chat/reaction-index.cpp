@@ -0,0 +1,94 @@
+#include "reaction-index.hpp"
+#include <QStringList>
+#include <QVariantMap>
+#include <algorithm>
+
+using namespace Messages;
+
+bool ReactionIndex::apply(const QString& messageId, const QJsonObject& reaction, const QString& publicKey)
+{
+	const QString id = reaction["id"].toString();
+	if(reaction["retracted"].toBool()) return remove(messageId, id);
+
+	QVector<Group>& groups = m_groups[messageId];
+	foreach(const Group& group, groups)
+	{
+		if(group.ids.contains(id)) return false;
+	}
+
+	const int emojiId = reaction["emojiId"].toInt();
+	auto it = std::lower_bound(groups.begin(), groups.end(), emojiId, [](const Group& g, int e) { return g.emojiId < e; });
+	if(it == groups.end() || it->emojiId != emojiId)
+	{
+		Group group;
+		group.emojiId = emojiId;
+		it = groups.insert(it, group);
+	}
+
+	const QString from = reaction["from"].toString();
+	if(from == publicKey) it->mine = it->ids.size();
+	it->ids << id;
+	it->from << from;
+	m_count++;
+	return true;
+}
+
+bool ReactionIndex::remove(const QString& messageId, const QString& reactionId)
+{
+	auto groups = m_groups.find(messageId);
+	if(groups == m_groups.end()) return false;
+
+	for(int g = 0; g < groups->size(); g++)
+	{
+		Group& group = (*groups)[g];
+		const int i = group.ids.indexOf(reactionId);
+		if(i == -1) continue;
+
+		group.ids.remove(i);
+		group.from.remove(i);
+		if(group.mine == i)
+			group.mine = -1;
+		else if(group.mine > i)
+			group.mine--;
+
+		if(group.ids.isEmpty()) groups->remove(g);
+		if(groups->isEmpty()) m_groups.erase(groups);
+		m_count--;
+		return true;
+	}
+
+	return false;
+}
+
+void ReactionIndex::clear()
+{
+	m_groups.clear();
+	m_count = 0;
+}
+
+QString ReactionIndex::mine(const QString& messageId, int emojiId) const
+{
+	foreach(const Group& group, m_groups.value(messageId))
+	{
+		if(group.emojiId == emojiId && group.mine != -1) return group.ids[group.mine];
+	}
+	return QString();
+}
+
+QVariantList ReactionIndex::toVariant(const QString& messageId) const
+{
+	QVariantList result;
+	foreach(const Group& group, m_groups.value(messageId))
+	{
+		result << QVariantMap{{"emojiId", group.emojiId},
+							  {"count", group.ids.size()},
+							  {"currentUserReacted", group.mine != -1},
+							  {"from", QStringList(group.from.toList())}};
+	}
+	return result;
+}
+
+int ReactionIndex::count() const
+{
+	return m_count;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <QHash>
+#include <QJsonObject>
+#include <QString>
+#include <QVariantList>
+#include <QVector>
+
+namespace Messages
+{
+
+// Emoji reactions of a chat, grouped by message and emoji. Each group keeps the
+// ids and authors of its reactions, and which one belongs to the current user,
+// so QML gets counts without going through every reaction
+class ReactionIndex
+{
+public:
+	// Adds or retracts a reaction. Returns true if the reactions of the message changed
+	bool apply(const QString& messageId, const QJsonObject& reaction, const QString& publicKey);
+	bool remove(const QString& messageId, const QString& reactionId);
+	void clear();
+
+	// Id of the reaction the current user sent with this emoji, if any
+	QString mine(const QString& messageId, int emojiId) const;
+
+	// [{emojiId, count, currentUserReacted, from}] ordered by emoji
+	QVariantList toVariant(const QString& messageId) const;
+
+	int count() const;
+
+private:
+	struct Group
+	{
+		int emojiId;
+		QVector<QString> ids;
+		QVector<QString> from;
+		int mine = -1;
+	};
+
+	QHash<QString, QVector<Group>> m_groups;
+	int m_count = 0;
+};
+
+} // namespace Messages
@@ -0,0 +1,925 @@
+#include "search-index.hpp"
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QSet>
+#include <QTextBoundaryFinder>
+#include <QtEndian>
+#include <algorithm>
+
+using namespace Messages;
+
+namespace
+{
+
+const quint32 Magic = 0x58444953; // "SIDX"
+const quint32 Version = 1;
+const int HeaderSize = 40;
+const int TermEntrySize = 24;
+const int IdEntrySize = 16;
+const int OffsetEntrySize = 16;
+
+// Longer words are indexed by their first characters, and only the start of the
+// text is kept for results
+const int MaxTokenLength = 32;
+const int MaxTextLength = 1000;
+
+// Query words shorter than this must match a whole word
+const int MinPrefixLength = 2;
+
+const char SenderField = '\x01';
+const char ChatField = '\x02';
+
+template <typename T> void append(QByteArray& out, T value)
+{
+	value = qToLittleEndian(value);
+	out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T> T read(const uchar* data)
+{
+	return qFromLittleEndian<T>(data);
+}
+
+void appendVarint(QByteArray& out, quint32 value)
+{
+	while(value >= 0x80)
+	{
+		out.append(char((value & 0x7f) | 0x80));
+		value >>= 7;
+	}
+	out.append(char(value));
+}
+
+quint32 readVarint(const uchar*& data)
+{
+	quint32 value = 0;
+	int shift = 0;
+	while(*data & 0x80)
+	{
+		value |= quint32(*data++ & 0x7f) << shift;
+		shift += 7;
+	}
+	return value | (quint32(*data++) << shift);
+}
+
+void appendString(QByteArray& out, const QString& value)
+{
+	const QByteArray utf8 = value.toUtf8();
+	append<quint32>(out, utf8.size());
+	out += utf8;
+}
+
+QString readString(const uchar*& data)
+{
+	const quint32 size = read<quint32>(data);
+	const QString value = QString::fromUtf8(reinterpret_cast<const char*>(data) + 4, size);
+	data += 4 + size;
+	return value;
+}
+
+// Message ids are hex encoded hashes, their first 64 bits are as good as the rest
+quint64 idHash(const QString& id)
+{
+	bool ok = false;
+	const quint64 value = id.startsWith("0x") && id.size() >= 18 ? id.midRef(2, 16).toULongLong(&ok, 16) : 0;
+	if(ok) return value;
+
+	// FNV-1a for anything else
+	quint64 hash = 14695981039346656037ull;
+	foreach(char c, id.toUtf8())
+	{
+		hash = (hash ^ quint8(c)) * 1099511628211ull;
+	}
+	return hash;
+}
+
+void sortUnique(QVector<quint32>& documents)
+{
+	std::sort(documents.begin(), documents.end());
+	documents.erase(std::unique(documents.begin(), documents.end()), documents.end());
+}
+
+} // namespace
+
+namespace Messages
+{
+
+// One flushed batch of the index. The file is laid out as:
+//   header      magic, version, term and id counts, table offsets
+//   postings    per term, varint deltas of its document numbers
+//   term table  per term, postings offset, size and count, term offset and length
+//   term blob   the terms, in byte order
+//   id table    hash of each message id and its document number, by hash
+class SearchSegment
+{
+public:
+	static std::shared_ptr<SearchSegment> open(const QString& fileName)
+	{
+		auto segment = std::make_shared<SearchSegment>();
+		segment->m_file.setFileName(fileName);
+		if(!segment->m_file.open(QIODevice::ReadOnly) || segment->m_file.size() < HeaderSize) return nullptr;
+
+		const qint64 size = segment->m_file.size();
+		const uchar* data = segment->m_file.map(0, size);
+		if(data == nullptr || read<quint32>(data) != Magic || read<quint32>(data + 4) != Version) return nullptr;
+
+		segment->m_data = data;
+		segment->m_termCount = read<quint32>(data + 8);
+		segment->m_idCount = read<quint32>(data + 12);
+		segment->m_termTable = read<quint64>(data + 16);
+		segment->m_termBlob = read<quint64>(data + 24);
+		segment->m_idTable = read<quint64>(data + 32);
+
+		if(segment->m_termTable + quint64(segment->m_termCount) * TermEntrySize > quint64(size) ||
+		   segment->m_idTable + quint64(segment->m_idCount) * IdEntrySize > quint64(size))
+		{
+			return nullptr;
+		}
+		return segment;
+	}
+
+	QString fileName() const
+	{
+		return m_file.fileName();
+	}
+
+	int termCount() const
+	{
+		return m_termCount;
+	}
+
+	QByteArray term(int i) const
+	{
+		const uchar* entry = m_data + m_termTable + quint64(i) * TermEntrySize;
+		const char* term = reinterpret_cast<const char*>(m_data + m_termBlob + read<quint32>(entry + 16));
+		return QByteArray::fromRawData(term, read<quint32>(entry + 20));
+	}
+
+	int lowerBound(const QByteArray& value) const
+	{
+		int first = 0;
+		int count = m_termCount;
+		while(count > 0)
+		{
+			const int step = count / 2;
+			if(term(first + step) < value)
+			{
+				first += step + 1;
+				count -= step + 1;
+			}
+			else
+			{
+				count = step;
+			}
+		}
+		return first;
+	}
+
+	void postings(int i, QVector<quint32>& out) const
+	{
+		const uchar* entry = m_data + m_termTable + quint64(i) * TermEntrySize;
+		const uchar* data = m_data + read<quint64>(entry);
+		const quint32 count = read<quint32>(entry + 12);
+
+		out.reserve(out.size() + count);
+		quint32 document = 0;
+		for(quint32 n = 0; n < count; n++)
+		{
+			document += readVarint(data);
+			out << document;
+		}
+	}
+
+	int idCount() const
+	{
+		return m_idCount;
+	}
+
+	quint64 idHash(int i) const
+	{
+		return read<quint64>(m_data + m_idTable + quint64(i) * IdEntrySize);
+	}
+
+	quint32 idDocument(int i) const
+	{
+		return read<quint32>(m_data + m_idTable + quint64(i) * IdEntrySize + 8);
+	}
+
+	// A merged segment can hold a message twice, when it was indexed again after an edit
+	void documents(quint64 hash, QVector<quint32>& out) const
+	{
+		int first = 0;
+		int count = m_idCount;
+		while(count > 0)
+		{
+			const int step = count / 2;
+			if(idHash(first + step) < hash)
+			{
+				first += step + 1;
+				count -= step + 1;
+			}
+			else
+			{
+				count = step;
+			}
+		}
+		for(int i = first; i < int(m_idCount) && idHash(i) == hash; i++)
+		{
+			out << idDocument(i);
+		}
+	}
+
+	bool contains(quint64 hash) const
+	{
+		int first = 0;
+		int last = m_idCount;
+		while(first < last)
+		{
+			const int middle = first + (last - first) / 2;
+			const quint64 value = idHash(middle);
+			if(value == hash) return true;
+			if(value < hash)
+				first = middle + 1;
+			else
+				last = middle;
+		}
+		return false;
+	}
+
+private:
+	QFile m_file;
+	const uchar* m_data = nullptr;
+	quint32 m_termCount = 0;
+	quint32 m_idCount = 0;
+	quint64 m_termTable = 0;
+	quint64 m_termBlob = 0;
+	quint64 m_idTable = 0;
+};
+
+// Writes a segment term by term, in byte order. Postings go straight to the
+// file, the term table is written once all terms are known
+class SearchSegmentWriter
+{
+public:
+	explicit SearchSegmentWriter(const QString& fileName)
+		: m_fileName(fileName)
+		, m_file(fileName + ".tmp")
+	{ }
+
+	bool open()
+	{
+		if(!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+		m_file.write(QByteArray(HeaderSize, 0));
+		m_offset = HeaderSize;
+		return true;
+	}
+
+	void add(const QByteArray& term, const QVector<quint32>& documents)
+	{
+		m_buffer.clear();
+		quint32 previous = 0;
+		foreach(quint32 document, documents)
+		{
+			appendVarint(m_buffer, document - previous);
+			previous = document;
+		}
+
+		append<quint64>(m_table, m_offset);
+		append<quint32>(m_table, m_buffer.size());
+		append<quint32>(m_table, documents.size());
+		append<quint32>(m_table, m_terms.size());
+		append<quint32>(m_table, term.size());
+		m_terms += term;
+		m_termCount++;
+
+		m_file.write(m_buffer);
+		m_offset += m_buffer.size();
+	}
+
+	bool finish(QVector<QPair<quint64, quint32>> ids)
+	{
+		std::sort(ids.begin(), ids.end());
+
+		QByteArray idTable;
+		idTable.reserve(ids.size() * IdEntrySize);
+		for(const auto& id : qAsConst(ids))
+		{
+			append<quint64>(idTable, id.first);
+			append<quint32>(idTable, id.second);
+			append<quint32>(idTable, 0);
+		}
+
+		QByteArray header;
+		append<quint32>(header, Magic);
+		append<quint32>(header, Version);
+		append<quint32>(header, m_termCount);
+		append<quint32>(header, ids.size());
+		append<quint64>(header, m_offset);
+		append<quint64>(header, m_offset + m_table.size());
+		append<quint64>(header, m_offset + m_table.size() + m_terms.size());
+
+		m_file.write(m_table);
+		m_file.write(m_terms);
+		m_file.write(idTable);
+		m_file.seek(0);
+		m_file.write(header);
+		m_file.close();
+		if(m_file.error() != QFileDevice::NoError) return false;
+
+		QFile::remove(m_fileName);
+		return m_file.rename(m_fileName);
+	}
+
+private:
+	QString m_fileName;
+	QFile m_file;
+	quint64 m_offset = 0;
+	quint32 m_termCount = 0;
+	QByteArray m_table;
+	QByteArray m_terms;
+	QByteArray m_buffer;
+};
+
+} // namespace Messages
+
+namespace
+{
+
+// Segments cover consecutive ranges of documents, so the postings of a term are
+// the concatenation of its postings in each segment. Removed documents are left out
+bool merge(const QVector<std::shared_ptr<SearchSegment>>& inputs, const QString& fileName, const QSet<quint32>& removed)
+{
+	SearchSegmentWriter writer(fileName);
+	if(!writer.open()) return false;
+
+	QVector<int> cursors(inputs.size(), 0);
+	QVector<quint32> documents;
+	forever
+	{
+		QByteArray next;
+		bool found = false;
+		for(int s = 0; s < inputs.size(); s++)
+		{
+			if(cursors[s] == inputs[s]->termCount()) continue;
+			const QByteArray term = inputs[s]->term(cursors[s]);
+			if(!found || term < next)
+			{
+				next = term;
+				found = true;
+			}
+		}
+		if(!found) break;
+
+		documents.clear();
+		for(int s = 0; s < inputs.size(); s++)
+		{
+			if(cursors[s] == inputs[s]->termCount() || inputs[s]->term(cursors[s]) != next) continue;
+			inputs[s]->postings(cursors[s]++, documents);
+		}
+		documents.erase(std::remove_if(documents.begin(), documents.end(), [&removed](quint32 d) { return removed.contains(d); }),
+						documents.end());
+		if(!documents.isEmpty()) writer.add(next, documents);
+	}
+
+	QVector<QPair<quint64, quint32>> ids;
+	foreach(const auto& segment, inputs)
+	{
+		for(int i = 0; i < segment->idCount(); i++)
+		{
+			if(!removed.contains(segment->idDocument(i))) ids << qMakePair(segment->idHash(i), segment->idDocument(i));
+		}
+	}
+	return writer.finish(ids);
+}
+
+} // namespace
+
+SearchIndex::SearchIndex(const QString& path)
+	: m_path(path)
+{ }
+
+SearchIndex::~SearchIndex() { }
+
+QString SearchIndex::filePath(const QString& name) const
+{
+	return m_path + "/" + name;
+}
+
+bool SearchIndex::open()
+{
+	QMutexLocker locker(&m_mutex);
+
+	QDir().mkpath(m_path);
+
+	QStringList segments;
+	QFile manifest(filePath("manifest.json"));
+	if(manifest.open(QIODevice::ReadOnly))
+	{
+		const QJsonObject obj = QJsonDocument::fromJson(manifest.readAll()).object();
+		if(obj["version"].toInt() == int(Version))
+		{
+			m_flushedCount = obj["documents"].toInt();
+			m_documentsSize = obj["documentsSize"].toString().toULongLong();
+			m_nextSegment = obj["nextSegment"].toInt();
+			foreach(const QJsonValue& name, obj["segments"].toArray())
+			{
+				segments << name.toString();
+			}
+			const QJsonObject cleared = obj["cleared"].toObject();
+			for(auto it = cleared.constBegin(); it != cleared.constEnd(); ++it)
+			{
+				m_cleared[it.key()] = it.value().toString().toULongLong();
+			}
+			foreach(const QJsonValue& document, obj["removed"].toArray())
+			{
+				m_removed << quint32(document.toDouble());
+			}
+		}
+	}
+
+	m_documents.setFileName(filePath("documents.dat"));
+	m_offsets.setFileName(filePath("documents.off"));
+	if(!m_documents.open(QIODevice::ReadWrite) || !m_offsets.open(QIODevice::ReadWrite))
+	{
+		qWarning() << "Could not open search index at" << m_path;
+		return false;
+	}
+
+	bool valid = quint64(m_documents.size()) >= m_documentsSize && quint64(m_offsets.size()) >= quint64(m_flushedCount) * OffsetEntrySize;
+	foreach(const QString& name, segments)
+	{
+		if(!valid) break;
+		auto segment = SearchSegment::open(filePath(name));
+		if(segment == nullptr)
+			valid = false;
+		else
+			m_segments << segment;
+	}
+
+	if(!valid)
+	{
+		// Start over, the messages are indexed again as they are loaded
+		qWarning() << "Search index at" << m_path << "is damaged, rebuilding it";
+		m_segments.clear();
+		m_flushedCount = 0;
+		m_documentsSize = 0;
+		m_cleared.clear();
+		m_removed.clear();
+		segments.clear();
+	}
+
+	// Drop whatever a flush or merge interrupted before the manifest was written
+	m_documents.resize(m_documentsSize);
+	m_offsets.resize(quint64(m_flushedCount) * OffsetEntrySize);
+	foreach(const QString& name, QDir(m_path).entryList({"segment-*"}, QDir::Files))
+	{
+		if(!segments.contains(name)) QFile::remove(filePath(name));
+	}
+
+	return mapDocuments() && writeManifest();
+}
+
+bool SearchIndex::mapDocuments()
+{
+	if(m_documentData != nullptr) m_documents.unmap(m_documentData);
+	if(m_offsetData != nullptr) m_offsets.unmap(m_offsetData);
+	m_documentData = m_documentsSize > 0 ? m_documents.map(0, m_documentsSize) : nullptr;
+	m_offsetData = m_flushedCount > 0 ? m_offsets.map(0, quint64(m_flushedCount) * OffsetEntrySize) : nullptr;
+
+	return (m_documentsSize == 0 || m_documentData != nullptr) && (m_flushedCount == 0 || m_offsetData != nullptr);
+}
+
+bool SearchIndex::writeManifest()
+{
+	QJsonArray segments;
+	foreach(const auto& segment, m_segments)
+	{
+		segments << QFileInfo(segment->fileName()).fileName();
+	}
+
+	QJsonObject cleared;
+	for(auto it = m_cleared.constBegin(); it != m_cleared.constEnd(); ++it)
+	{
+		cleared[it.key()] = QString::number(it.value());
+	}
+
+	QJsonArray removed;
+	foreach(quint32 document, m_removed)
+	{
+		removed << double(document);
+	}
+
+	QSaveFile manifest(filePath("manifest.json"));
+	if(!manifest.open(QIODevice::WriteOnly)) return false;
+
+	QJsonObject obj{{"version", int(Version)},
+					{"documents", int(m_flushedCount)},
+					{"documentsSize", QString::number(m_documentsSize)},
+					{"nextSegment", m_nextSegment},
+					{"segments", segments},
+					{"cleared", cleared},
+					{"removed", removed}};
+	manifest.write(QJsonDocument(obj).toJson(QJsonDocument::Compact));
+	return manifest.commit();
+}
+
+QVector<QByteArray> SearchIndex::tokenize(const QString& text)
+{
+	// Case and accent insensitive: fold the case, decompose and drop the combining marks
+	const QString decomposed = text.toCaseFolded().normalized(QString::NormalizationForm_KD);
+	QString folded;
+	folded.reserve(decomposed.size());
+	foreach(const QChar& c, decomposed)
+	{
+		if(c.category() != QChar::Mark_NonSpacing) folded += c;
+	}
+
+	QVector<QByteArray> tokens;
+	QTextBoundaryFinder finder(QTextBoundaryFinder::Word, folded);
+	int start = 0;
+	while(finder.toNextBoundary() != -1)
+	{
+		const int end = finder.position();
+		if(finder.boundaryReasons() & QTextBoundaryFinder::EndOfItem)
+		{
+			const QStringRef word = folded.midRef(start, end - start);
+			if(!word.isEmpty() && word.at(0).isLetterOrNumber()) tokens << word.left(MaxTokenLength).toUtf8();
+		}
+		start = end;
+	}
+	return tokens;
+}
+
+QVector<quint32> SearchIndex::documentsOf(quint64 idHash) const
+{
+	QVector<quint32> documents;
+	foreach(const auto& segment, m_segments)
+	{
+		segment->documents(idHash, documents);
+	}
+	if(m_pendingIds.contains(idHash)) documents << m_pendingIds[idHash];
+	return documents;
+}
+
+bool SearchIndex::indexed(quint64 idHash) const
+{
+	// A removed message can be indexed again, with its new text
+	foreach(quint32 document, documentsOf(idHash))
+	{
+		if(!m_removed.contains(document)) return true;
+	}
+	return false;
+}
+
+bool SearchIndex::add(const Document& document)
+{
+	QMutexLocker locker(&m_mutex);
+
+	const quint64 hash = idHash(document.id);
+	if(indexed(hash)) return false;
+
+	QSet<QByteArray> terms;
+	foreach(const QByteArray& token, tokenize(document.text))
+	{
+		terms << token;
+	}
+	foreach(const QByteArray& token, tokenize(document.sender))
+	{
+		terms << SenderField + token;
+	}
+	terms << SenderField + document.from.toLower().toUtf8();
+	terms << ChatField + document.chatId.toUtf8();
+
+	const quint32 number = m_flushedCount + m_pendingDocuments.size();
+	foreach(const QByteArray& term, terms)
+	{
+		m_pending[term] << number;
+	}
+
+	Document stored = document;
+	stored.text.truncate(MaxTextLength);
+	m_pendingDocuments << stored;
+	m_pendingIds.insert(hash, number);
+	return true;
+}
+
+int SearchIndex::pendingCount() const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_pendingDocuments.size();
+}
+
+void SearchIndex::flush()
+{
+	QMutexLocker locker(&m_mutex);
+	if(m_pendingDocuments.isEmpty()) return;
+
+	const QString name = QString("segment-%1.idx").arg(m_nextSegment);
+	SearchSegmentWriter writer(filePath(name));
+	if(!writer.open())
+	{
+		qWarning() << "Could not write search index segment" << name;
+		return;
+	}
+	QVector<quint32> documents;
+	for(auto it = m_pending.constBegin(); it != m_pending.constEnd(); ++it)
+	{
+		documents.clear();
+		foreach(quint32 document, it.value())
+		{
+			if(!m_removed.contains(document)) documents << document;
+		}
+		if(!documents.isEmpty()) writer.add(it.key(), documents);
+	}
+
+	QVector<QPair<quint64, quint32>> ids;
+	for(auto it = m_pendingIds.constBegin(); it != m_pendingIds.constEnd(); ++it)
+	{
+		if(!m_removed.contains(it.value())) ids << qMakePair(it.key(), it.value());
+	}
+	if(!writer.finish(ids))
+	{
+		qWarning() << "Could not write search index segment" << name;
+		return;
+	}
+
+	QByteArray records;
+	QByteArray offsets;
+	foreach(const Document& document, m_pendingDocuments)
+	{
+		append<quint64>(offsets, m_documentsSize + records.size());
+		append<quint64>(offsets, document.clock);
+		appendString(records, document.id);
+		appendString(records, document.chatId);
+		appendString(records, document.from);
+		appendString(records, document.text);
+	}
+
+	m_documents.seek(m_documentsSize);
+	m_offsets.seek(quint64(m_flushedCount) * OffsetEntrySize);
+	if(m_documents.write(records) != records.size() || m_offsets.write(offsets) != offsets.size() || !m_documents.flush() ||
+	   !m_offsets.flush())
+	{
+		qWarning() << "Could not write search index documents";
+		return;
+	}
+
+	auto segment = SearchSegment::open(filePath(name));
+	if(segment == nullptr) return;
+
+	m_segments << segment;
+	m_nextSegment++;
+	m_flushedCount += m_pendingDocuments.size();
+	m_documentsSize += records.size();
+	m_pending.clear();
+	m_pendingDocuments.clear();
+	m_pendingIds.clear();
+
+	mapDocuments();
+	writeManifest();
+}
+
+void SearchIndex::compact()
+{
+	QVector<std::shared_ptr<SearchSegment>> inputs;
+	QSet<quint32> removed;
+	QString name;
+	{
+		QMutexLocker locker(&m_mutex);
+		if(m_compacting || m_segments.size() <= MaxSegments) return;
+		m_compacting = true;
+		inputs = m_segments;
+		removed = m_removed;
+		name = QString("segment-%1.idx").arg(m_nextSegment++);
+	}
+
+	// Segments are immutable, searches and flushes go on while they are merged
+	const bool merged = merge(inputs, filePath(name), removed);
+
+	QMutexLocker locker(&m_mutex);
+	m_compacting = false;
+
+	auto segment = merged ? SearchSegment::open(filePath(name)) : nullptr;
+	if(segment == nullptr)
+	{
+		qWarning() << "Could not merge search index segments";
+		return;
+	}
+
+	m_segments.remove(0, inputs.size());
+	m_segments.prepend(segment);
+	writeManifest();
+
+	QStringList obsolete;
+	foreach(const auto& input, inputs)
+	{
+		obsolete << input->fileName();
+	}
+	inputs.clear();
+	foreach(const QString& fileName, obsolete)
+	{
+		QFile::remove(fileName);
+	}
+}
+
+void SearchIndex::clearChat(const QString& chatId, quint64 clock)
+{
+	QMutexLocker locker(&m_mutex);
+	m_cleared[chatId] = std::max(m_cleared.value(chatId), clock);
+
+	// The deleted messages don't keep their text on disk either
+	foreach(quint32 document, lookup(ChatField + chatId.toUtf8(), false))
+	{
+		if(clockOf(document) > clock || m_removed.contains(document)) continue;
+		m_removed << document;
+		scrub(document);
+	}
+	writeManifest();
+}
+
+bool SearchIndex::remove(const QString& id)
+{
+	QMutexLocker locker(&m_mutex);
+
+	bool removed = false;
+	foreach(quint32 document, documentsOf(idHash(id)))
+	{
+		if(m_removed.contains(document)) continue;
+		m_removed << document;
+		scrub(document);
+		removed = true;
+	}
+	if(removed) writeManifest();
+	return removed;
+}
+
+void SearchIndex::scrub(quint32 document)
+{
+	if(document >= m_flushedCount)
+	{
+		m_pendingDocuments[document - m_flushedCount].text.clear();
+		return;
+	}
+
+	// The record is id, chat id, sender and text. The text is overwritten in place
+	const uchar* data = m_documentData + read<quint64>(m_offsetData + quint64(document) * OffsetEntrySize);
+	for(int field = 0; field < 3; field++)
+	{
+		data += 4 + read<quint32>(data);
+	}
+	const quint32 size = read<quint32>(data);
+	m_documents.seek(data + 4 - m_documentData);
+	if(m_documents.write(QByteArray(size, 0)) != size || !m_documents.flush())
+	{
+		qWarning() << "Could not remove a message from the search index";
+	}
+}
+
+QVector<quint32> SearchIndex::lookup(const QByteArray& term, bool prefix) const
+{
+	QVector<quint32> documents;
+	int matches = 0;
+
+	foreach(const auto& segment, m_segments)
+	{
+		for(int i = segment->lowerBound(term); i < segment->termCount(); i++)
+		{
+			const QByteArray candidate = segment->term(i);
+			if(prefix ? !candidate.startsWith(term) : candidate != term) break;
+			segment->postings(i, documents);
+			matches++;
+		}
+	}
+
+	for(auto it = m_pending.lowerBound(term); it != m_pending.constEnd(); ++it)
+	{
+		if(prefix ? !it.key().startsWith(term) : it.key() != term) break;
+		documents += it.value();
+		matches++;
+	}
+
+	// A single term comes out sorted, segments and pending documents being in document order
+	if(matches > 1) sortUnique(documents);
+	return documents;
+}
+
+quint64 SearchIndex::clockOf(quint32 document) const
+{
+	if(document >= m_flushedCount) return m_pendingDocuments[document - m_flushedCount].clock;
+	return read<quint64>(m_offsetData + quint64(document) * OffsetEntrySize + 8);
+}
+
+SearchIndex::Hit SearchIndex::hitOf(quint32 document) const
+{
+	if(document >= m_flushedCount)
+	{
+		const Document& d = m_pendingDocuments[document - m_flushedCount];
+		return Hit{d.id, d.chatId, d.from, d.clock, d.text};
+	}
+
+	const uchar* entry = m_offsetData + quint64(document) * OffsetEntrySize;
+	const uchar* data = m_documentData + read<quint64>(entry);
+	Hit hit;
+	hit.clock = read<quint64>(entry + 8);
+	hit.id = readString(data);
+	hit.chatId = readString(data);
+	hit.from = readString(data);
+	hit.text = readString(data);
+	return hit;
+}
+
+QVector<SearchIndex::Hit> SearchIndex::search(const QString& query, const QString& chatId, int limit) const
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	QVector<QPair<QByteArray, bool>> terms;
+	foreach(QString word, query.split(' ', QString::SkipEmptyParts))
+	{
+		QByteArray field;
+		if(word.startsWith("from:", Qt::CaseInsensitive))
+		{
+			field = QByteArray(1, SenderField);
+			word = word.mid(5);
+		}
+		foreach(const QByteArray& token, tokenize(word))
+		{
+			terms << qMakePair(field + token, QString::fromUtf8(token).size() >= MinPrefixLength);
+		}
+	}
+	if(terms.isEmpty()) return {};
+
+	QMutexLocker locker(&m_mutex);
+
+	QVector<QVector<quint32>> lists;
+	for(const auto& term : qAsConst(terms))
+	{
+		lists << lookup(term.first, term.second);
+		if(lists.last().isEmpty()) return {};
+	}
+	if(!chatId.isEmpty()) lists << lookup(ChatField + chatId.toUtf8(), false);
+
+	// Intersect starting from the rarest term
+	std::sort(lists.begin(), lists.end(), [](const QVector<quint32>& a, const QVector<quint32>& b) { return a.size() < b.size(); });
+	QVector<quint32> documents = lists.first();
+	QVector<quint32> intersection;
+	for(int i = 1; i < lists.size() && !documents.isEmpty(); i++)
+	{
+		intersection.clear();
+		std::set_intersection(documents.begin(), documents.end(), lists[i].begin(), lists[i].end(), std::back_inserter(intersection));
+		documents.swap(intersection);
+	}
+
+	QVector<QPair<quint64, quint32>> ranked;
+	ranked.reserve(documents.size());
+	foreach(quint32 document, documents)
+	{
+		ranked << qMakePair(clockOf(document), document);
+	}
+	// Only the first page is sorted, unless hidden hits from cleared chats or removed messages push it further
+	int sorted = std::min(limit, ranked.size());
+	std::partial_sort(ranked.begin(), ranked.begin() + sorted, ranked.end(), std::greater<QPair<quint64, quint32>>());
+
+	QVector<Hit> hits;
+	for(int i = 0; i < ranked.size() && hits.size() < limit; i++)
+	{
+		if(i == sorted)
+		{
+			std::sort(ranked.begin() + sorted, ranked.end(), std::greater<QPair<quint64, quint32>>());
+			sorted = ranked.size();
+		}
+
+		if(m_removed.contains(ranked[i].second)) continue;
+		const Hit hit = hitOf(ranked[i].second);
+		if(m_cleared.contains(hit.chatId) && hit.clock <= m_cleared[hit.chatId]) continue;
+		hits << hit;
+	}
+
+	m_searches++;
+	m_searchTimeUs += timer.nsecsElapsed() / 1000;
+	return hits;
+}
+
+int SearchIndex::count() const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_flushedCount + m_pendingDocuments.size();
+}
+
+QVariantMap SearchIndex::stats() const
+{
+	QMutexLocker locker(&m_mutex);
+	return QVariantMap{{"documents", m_flushedCount + m_pendingDocuments.size()},
+					   {"pending", m_pendingDocuments.size()},
+					   {"removed", m_removed.size()},
+					   {"segments", m_segments.size()},
+					   {"searches", m_searches},
+					   {"averageSearchUs", m_searches > 0 ? m_searchTimeUs / qint64(m_searches) : 0}};
+}
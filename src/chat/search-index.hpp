@@ -0,0 +1,117 @@
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+#include <QVariantMap>
+#include <QVector>
+#include <memory>
+
+namespace Messages
+{
+
+class SearchSegment;
+
+// Inverted index of chat messages, kept on disk under `path`.
+// New messages are indexed in memory and written out by flush() as an immutable
+// segment: a sorted term dictionary followed by delta encoded posting lists.
+// Segments and the document table are memory mapped, so opening an index only
+// reads its manifest. compact() merges the segments once there are too many.
+// Terms are case folded, accent stripped Unicode words. Sender terms (alias,
+// ENS name, public key) and chat ids live in their own namespaces, and every
+// query word matches as a prefix
+class SearchIndex
+{
+public:
+	struct Document
+	{
+		QString id;
+		QString chatId;
+		QString from;
+		QString sender;
+		quint64 clock;
+		QString text;
+	};
+
+	struct Hit
+	{
+		QString id;
+		QString chatId;
+		QString from;
+		quint64 clock;
+		QString text;
+	};
+
+	explicit SearchIndex(const QString& path);
+	~SearchIndex();
+
+	bool open();
+
+	// Returns false if the message is already indexed
+	bool add(const Document& document);
+	int pendingCount() const;
+	void flush();
+	void compact();
+
+	// Hides the messages of a chat up to `clock`, after its history is deleted
+	void clearChat(const QString& chatId, quint64 clock);
+	// Hides a message and blanks its stored text, when it is deleted or edited. It
+	// can be added again afterwards. Returns false if it wasn't indexed
+	bool remove(const QString& id);
+
+	// Newest first. "from:name" restricts a word to the sender
+	QVector<Hit> search(const QString& query, const QString& chatId = QString(), int limit = 50) const;
+
+	int count() const;
+	QVariantMap stats() const;
+
+	static QVector<QByteArray> tokenize(const QString& text);
+
+private:
+	static const int MaxSegments = 8;
+
+	QString filePath(const QString& name) const;
+	bool writeManifest();
+	bool mapDocuments();
+	quint64 clockOf(quint32 document) const;
+	Hit hitOf(quint32 document) const;
+	QVector<quint32> lookup(const QByteArray& term, bool prefix) const;
+	QVector<quint32> documentsOf(quint64 idHash) const;
+	// Whether the message has a document that wasn't removed
+	bool indexed(quint64 idHash) const;
+	void scrub(quint32 document);
+
+	QString m_path;
+	mutable QMutex m_mutex;
+
+	QVector<std::shared_ptr<SearchSegment>> m_segments;
+	int m_nextSegment = 0;
+	bool m_compacting = false;
+
+	// Document table: a record per message in documents.dat, and its offset and
+	// clock in documents.off
+	QFile m_documents;
+	QFile m_offsets;
+	uchar* m_documentData = nullptr;
+	uchar* m_offsetData = nullptr;
+	quint32 m_flushedCount = 0;
+	quint64 m_documentsSize = 0;
+
+	// Indexed since the last flush
+	QMap<QByteArray, QVector<quint32>> m_pending;
+	QVector<Document> m_pendingDocuments;
+	QHash<quint64, quint32> m_pendingIds;
+
+	QHash<QString, quint64> m_cleared;
+	// Documents of deleted or edited messages
+	QSet<quint32> m_removed;
+
+	mutable quint64 m_searches = 0;
+	mutable qint64 m_searchTimeUs = 0;
+};
+
+} // namespace Messages
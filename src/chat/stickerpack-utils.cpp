@@ -30,17 +30,35 @@ int StickerPackUtils::getPackCount()
 	return ok ? result : 0;
 }
 
-StickerPack* StickerPackUtils::getPackData(int packId)
+QVector<StickerPack*> StickerPackUtils::getPackData(QVector<int> packIds)
 {
 	QString getPackData = methodSignature("getPackData(uint256)");
-	QJsonObject payload{
-		{"to", Constants::StickersAddress},
-		{"from", Constants::ZeroAddress},
-		{"data", getPackData + QString::fromStdString(uint256_t(packId).str(16, 64))},
-	};
-	const auto response = Status::instance()->callPrivateRPC("eth_call", QJsonArray{payload, "latest"}.toVariantList()).toJsonObject();
-	// TODO: error handling
 
+	QVector<RpcCall> calls;
+	foreach(int packId, packIds)
+	{
+		QJsonObject payload{
+			{"to", Constants::StickersAddress},
+			{"from", Constants::ZeroAddress},
+			{"data", getPackData + QString::fromStdString(uint256_t(packId).str(16, 64))},
+		};
+		calls << RpcCall{"eth_call", QJsonArray{payload, "latest"}.toVariantList()};
+	}
+
+	const QVector<QJsonObject> responses = Status::instance()->callPrivateRPCBatch(calls);
+
+	QVector<StickerPack*> stickerPacks;
+	for(int i = 0; i < packIds.size(); i++)
+	{
+		// TODO: error handling
+		StickerPack* stickerPack = decodePackData(packIds[i], responses[i]);
+		if(stickerPack != nullptr) stickerPacks << stickerPack;
+	}
+	return stickerPacks;
+}
+
+StickerPack* StickerPackUtils::decodePackData(int packId, const QJsonObject& response)
+{
 	// TODO: extract to decode lib
 	bool ok = false;
 	QString data = response["result"].toString().right(response["result"].toString().size() - 2);
@@ -1,10 +1,13 @@
 #pragma once
 
 #include "stickerpack.hpp"
+#include <QJsonObject>
+#include <QVector>
 
 namespace StickerPackUtils
 {
 int getPackCount();
-StickerPack* getPackData(int packId);
+QVector<StickerPack*> getPackData(QVector<int> packIds);
+StickerPack* decodePackData(int packId, const QJsonObject& response);
 
 } // namespace StickerPackUtils
\ No newline at end of file
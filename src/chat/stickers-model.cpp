@@ -83,7 +83,7 @@ QVariant StickerPacksModel::data(const QModelIndex& index, int role) const
 
 void StickerPacksModel::loadStickerPacks()
 {
-	QtConcurrent::run([&] {
+	Status::instance()->rpcExecutor()->run(RpcExecutor::Background, [this] {
 		m_installedStickersLock.lockForWrite();
 		foreach(const QString& packId, Settings::instance()->installedStickerPacks().keys())
 		{
@@ -98,12 +98,15 @@ void StickerPacksModel::loadStickerPacks()
 		diskCache->setCacheDirectory(Constants::cachePath("/stickers/network"));
 		manager->setCache(diskCache);
 
+		QVector<int> packIds;
 		int numPacks = StickerPackUtils::getPackCount();
 		for(int i = 0; i < numPacks; i++)
 		{
-			StickerPack* stickerPack = StickerPackUtils::getPackData(i);
-			if(stickerPack == nullptr) continue;
-			
+			packIds << i;
+		}
+
+		foreach(StickerPack* stickerPack, StickerPackUtils::getPackData(packIds))
+		{
 			stickerPack->loadContent(manager);
 			stickerPack->moveToThread(QApplication::instance()->thread());
 			emit stickerPackLoaded(stickerPack);
@@ -142,7 +145,7 @@ void StickerPacksModel::install(int packId)
 			m_installedStickersLock.unlock();
 			
 			QModelIndex idx = createIndex(i, 0);
-			dataChanged(idx, idx);
+			dataChanged(idx, idx, {Installed});
 			return;
 		}
 	}
@@ -164,7 +167,7 @@ void StickerPacksModel::uninstall(int packId)
 			Settings::instance()->removeRecentStickerPack(packId);
 
 			QModelIndex idx = createIndex(i, 0);
-			dataChanged(idx, idx);
+			dataChanged(idx, idx, {Installed});
 			break;
 		}
 	}
@@ -159,6 +159,31 @@ void Contact::toggleBlock()
 	// TODO: react to blockedToggled to add/remove timeline chat
 }
 
+QJsonObject Contact::toJson() const
+{
+	QJsonObject obj{{"id", m_id},
+					{"address", m_address},
+					{"name", m_name},
+					{"ensVerified", m_ensVerified},
+					{"ensVerifiedAt", m_ensVerifiedAt},
+					{"lastENSClockValue", m_lastENSClockValue},
+					{"ensVerificationRetries", m_ensVerificationRetries},
+					{"alias", m_alias},
+					{"identicon", m_identicon},
+					{"lastUpdated", m_lastUpdated},
+					{"tributeToTalk", m_tributeToTalk},
+					{"systemTags", QJsonArray::fromStringList(m_systemTags.toList())},
+					{"localNickname", m_localNickname}};
+
+	if(!m_images.isEmpty())
+	{
+		const ContactImage& image = m_images.last();
+		obj["images"] = QJsonObject{{"thumbnail", QJsonObject{{"type", image.type}, {"uri", image.uri}}}};
+	}
+
+	return obj;
+}
+
 void Contact::save()
 {
 	QtConcurrent::run([=] {
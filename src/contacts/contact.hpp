@@ -72,6 +72,9 @@ public:
 	QVector<ContactImage> getImages();
 	QVector<QString> getSystemTags();
 
+	// Same shape as the status-go contact it was built from
+	QJsonObject toJson() const;
+
 	Q_INVOKABLE void save();
 	Q_INVOKABLE void changeNickname(QString newNickname);
 	Q_INVOKABLE void toggleAdd();
@@ -12,6 +12,7 @@
 #include <QJsonObject>
 #include <QJsonValue>
 #include <QQmlApplicationEngine>
+#include <QTimer>
 #include <QtConcurrent/QtConcurrent>
 #include <algorithm>
 #include <array>
@@ -73,13 +74,23 @@ QVariant ContactsModel::data(const QModelIndex& index, int role) const
 	return QVariant();
 }
 
-void ContactsModel::contactUpdated(QString contactId)
+void ContactsModel::changed(Contact* contact, const QVector<int>& roles)
 {
-	if(!m_contactsMap.contains(contactId))
-		return;
-	int index = m_contacts.indexOf(m_contactsMap[contactId]);
-	QModelIndex idx = createIndex(index, 0);
-	dataChanged(idx, idx);
+	m_changes.add(contact, roles);
+	if(m_changesScheduled) return;
+	m_changesScheduled = true;
+	QTimer::singleShot(0, this, &ContactsModel::flushChanges);
+}
+
+void ContactsModel::flushChanges()
+{
+	m_changesScheduled = false;
+	const QList<Contact*> contacts = m_changes.keys();
+	m_changes.flush(this, [this](Contact* contact) { return m_contacts.indexOf(contact); });
+	foreach(Contact* contact, contacts)
+	{
+		emit updated(contact->get_id());
+	}
 }
 
 void ContactsModel::loadContacts()
@@ -122,10 +133,16 @@ void ContactsModel::insert(Contact* contact)
 	m_contactsMap[contact->get_id()] = contact;
 	endInsertRows();
 	emit added(contact->get_id());
-	QObject::connect(contact, &Contact::contactToggled, this, &ContactsModel::contactUpdated);
 	QObject::connect(contact, &Contact::contactToggled, this, &ContactsModel::contactToggled);
-	QObject::connect(contact, &Contact::blockedToggled, this, &ContactsModel::contactUpdated);
-	QObject::connect(contact, &Contact::imageChanged, this, &ContactsModel::contactUpdated);
+	QObject::connect(contact, &Contact::contactToggled, this, [this, contact] { changed(contact, {IsAdded}); });
+	QObject::connect(contact, &Contact::blockedToggled, this, [this, contact] { changed(contact, {IsBlocked}); });
+	QObject::connect(contact, &Contact::imageChanged, this, [this, contact] { changed(contact, {Image}); });
+	QObject::connect(contact, &Contact::nameChanged, this, [this, contact] { changed(contact, {Name}); });
+	QObject::connect(contact, &Contact::localNicknameChanged, this, [this, contact] { changed(contact, {LocalNickname}); });
+	QObject::connect(contact, &Contact::aliasChanged, this, [this, contact] { changed(contact, {Alias}); });
+	QObject::connect(contact, &Contact::identiconChanged, this, [this, contact] { changed(contact, {Identicon}); });
+	QObject::connect(contact, &Contact::addressChanged, this, [this, contact] { changed(contact, {Address}); });
+	QObject::connect(contact, &Contact::ensVerifiedChanged, this, [this, contact] { changed(contact, {EnsVerified}); });
 }
 
 Contact* ContactsModel::get(int row) const
@@ -150,18 +167,18 @@ Contact* ContactsModel::get_or_create(QString id)
 
 Contact* ContactsModel::upsert(Message* msg)
 {
-	if(m_contactsMap.contains(msg->get_from()))
-	{
-		msg->update_contact(m_contactsMap[msg->get_from()]);
-		return m_contactsMap[msg->get_from()];
-	}
-	else
-	{
-		Contact* newContact = new Contact(msg->get_from(), msg->get_ensName());
-		msg->update_contact(newContact);
-		insert(newContact);
-		return newContact;
-	}
+	Contact* contact = upsert(msg->get_from(), msg->get_ensName());
+	msg->update_contact(contact);
+	return contact;
+}
+
+Contact* ContactsModel::upsert(QString id, QString ensName)
+{
+	if(m_contactsMap.contains(id)) return m_contactsMap[id];
+
+	Contact* newContact = new Contact(id, ensName);
+	insert(newContact);
+	return newContact;
 }
 
 Contact* ContactsModel::upsert(Chat* chat)
@@ -188,13 +205,9 @@ void ContactsModel::update(QJsonValue updates)
 		QString contactId = contactJson["id"].toString();
 		if(m_contactsMap.contains(contactId))
 		{
-			int contactIndex = m_contacts.indexOf(m_contactsMap[contactId]);
+			// The system tags behind isAdded and isBlocked change without a signal
 			m_contactsMap[contactId]->update(contactJson);
-			if(contactIndex > -1)
-			{
-				QModelIndex idx = createIndex(contactIndex, 0);
-				dataChanged(idx, idx);
-			}
+			changed(m_contactsMap[contactId], {IsAdded, IsBlocked});
 		}
 		else
 		{
@@ -2,6 +2,7 @@
 
 #include "message.hpp"
 #include "contact.hpp"
+#include "role-changes.hpp"
 #include <QAbstractListModel>
 #include <QHash>
 #include <QVector>
@@ -39,10 +40,10 @@ public:
 	Q_INVOKABLE Contact* get(int row) const;
 	Q_INVOKABLE Contact* get(QString id) const;
 	Q_INVOKABLE Contact* get_or_create(QString id);
-	Q_INVOKABLE void contactUpdated(QString id);
 	Q_INVOKABLE void push(Contact* contact);
 
 	Contact* upsert(Message* msg);
+	Contact* upsert(QString id, QString ensName);
 	Contact* upsert(Chat* chat);
 
 signals:
@@ -54,7 +55,14 @@ private:
 	void loadContacts();
 	void update(QJsonValue updates);
 	void insert(Contact* contact);
+	// Records the roles a contact changed. They are announced, along with updated(),
+	// once control returns to the event loop
+	void changed(Contact* contact, const QVector<int>& roles);
+	void flushChanges();
 
 	QVector<Contact*> m_contacts;
 	QHash<QString, Contact*> m_contactsMap;
+
+	RoleChanges<Contact*> m_changes;
+	bool m_changesScheduled = false;
 };
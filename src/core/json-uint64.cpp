@@ -0,0 +1,146 @@
+#include "json-uint64.hpp"
+#include <QByteArray>
+#include <QLatin1String>
+#include <array>
+#include <cstring>
+
+namespace
+{
+
+// Keys whose values are uint64 on the status-go side. Add new keys here.
+const std::array<QLatin1String, 9> uint64Keys{QLatin1String("lastClockValue"),
+											  QLatin1String("timestamp"),
+											  QLatin1String("deletedAtClockValue"),
+											  QLatin1String("clock"),
+											  QLatin1String("clockValue"),
+											  QLatin1String("whisperTimestamp"),
+											  QLatin1String("ensVerifiedAt"),
+											  QLatin1String("lastENSClockValue"),
+											  QLatin1String("lastUpdated")};
+
+enum class Mode
+{
+	Quote,
+	Unquote
+};
+
+bool isUint64Key(const char* begin, int length)
+{
+	for(const QLatin1String& key : uint64Keys)
+	{
+		if(key.size() == length && std::memcmp(key.data(), begin, length) == 0) return true;
+	}
+	return false;
+}
+
+inline bool isDigit(char c)
+{
+	return c >= '0' && c <= '9';
+}
+
+inline const char* skipWhitespace(const char* p, const char* end)
+{
+	while(p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+		++p;
+	return p;
+}
+
+inline const char* skipDigits(const char* p, const char* end)
+{
+	while(p < end && isDigit(*p))
+		++p;
+	return p;
+}
+
+// Returns the closing quote of the string starting at `p` (just after the
+// opening quote), or `end` if the string is not terminated
+const char* stringEnd(const char* p, const char* end)
+{
+	while(true)
+	{
+		p = static_cast<const char*>(std::memchr(p, '"', end - p));
+		if(p == nullptr) return end;
+
+		// The opening quote stops this walk, so it never leaves the string
+		const char* backslash = p;
+		while(backslash[-1] == '\\')
+			--backslash;
+		if(((p - backslash) & 1) == 0) return p;
+		++p;
+	}
+}
+
+QByteArray rewrite(const QByteArray& json, Mode mode)
+{
+	const char* begin = json.constData();
+	const char* end = begin + json.size();
+	const char* p = begin;
+	const char* copied = begin;
+
+	QByteArray result;
+	bool modified = false;
+
+	while(p < end)
+	{
+		p = static_cast<const char*>(std::memchr(p, '"', end - p));
+		if(p == nullptr) break;
+
+		const char* str = p + 1;
+		const char* strEnd = stringEnd(str, end);
+		if(strEnd >= end) break;
+
+		p = strEnd + 1;
+		if(!isUint64Key(str, strEnd - str)) continue;
+
+		// Only strings followed by a colon are keys
+		const char* value = skipWhitespace(p, end);
+		if(value >= end || *value != ':') continue;
+		value = skipWhitespace(value + 1, end);
+		if(value >= end) continue;
+
+		const char* digits = mode == Mode::Quote ? value : value + 1;
+		const char* digitsEnd = skipDigits(digits, end);
+		if(digitsEnd == digits || digitsEnd >= end) continue;
+
+		if(mode == Mode::Quote)
+		{
+			// Leave floats and exponents alone, they are not uint64
+			if(*digitsEnd == '.' || *digitsEnd == 'e' || *digitsEnd == 'E') continue;
+		}
+		else
+		{
+			if(*value != '"' || *digitsEnd != '"') continue;
+		}
+
+		if(!modified)
+		{
+			result.reserve(json.size() + (mode == Mode::Quote ? 64 : 0));
+			modified = true;
+		}
+
+		result.append(copied, value - copied);
+		if(mode == Mode::Quote) result.append('"');
+		result.append(digits, digitsEnd - digits);
+		if(mode == Mode::Quote) result.append('"');
+
+		copied = mode == Mode::Quote ? digitsEnd : digitsEnd + 1;
+		p = copied;
+	}
+
+	if(!modified) return json;
+
+	result.append(copied, end - copied);
+	return result;
+}
+
+} // namespace
+
+QByteArray JsonUint64::quote(const QByteArray& json)
+{
+	return rewrite(json, Mode::Quote);
+}
+
+QByteArray JsonUint64::unquote(const QByteArray& json)
+{
+	return rewrite(json, Mode::Unquote);
+}
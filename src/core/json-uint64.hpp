@@ -0,0 +1,17 @@
+#pragma once
+
+#include <QByteArray>
+
+// status-go encodes clocks and timestamps as uint64 JSON numbers, which do not
+// fit in the double used by QJsonValue. These helpers rewrite the values of the
+// keys listed in json-uint64.cpp in a single pass over the UTF-8 payload.
+namespace JsonUint64
+{
+
+// "clock":1234 -> "clock":"1234"
+QByteArray quote(const QByteArray& json);
+
+// "clock":"1234" -> "clock":1234
+QByteArray unquote(const QByteArray& json);
+
+} // namespace JsonUint64
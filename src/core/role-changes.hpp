@@ -0,0 +1,69 @@
+#pragma once
+
+#include <QAbstractItemModel>
+#include <QHash>
+#include <QMap>
+#include <QVector>
+#include <algorithm>
+
+// Roles touched per item since the last flush. Items are keyed by something
+// that survives row moves (a pointer, a store slot), and flush() maps them to
+// rows: one dataChanged per run of adjacent rows that changed the same roles
+template<typename Key>
+class RoleChanges
+{
+public:
+	void add(const Key& key, const QVector<int>& roles)
+	{
+		QVector<int>& pending = m_changes[key];
+		foreach(int role, roles)
+		{
+			if(!pending.contains(role)) pending << role;
+		}
+	}
+
+	void remove(const Key& key)
+	{
+		m_changes.remove(key);
+	}
+
+	bool isEmpty() const
+	{
+		return m_changes.isEmpty();
+	}
+
+	QList<Key> keys() const
+	{
+		return m_changes.keys();
+	}
+
+	// rowOf returns the current row of a key, or -1 if it is no longer shown
+	template<typename RowOf>
+	void flush(QAbstractItemModel* model, RowOf rowOf)
+	{
+		QMap<int, QVector<int>> rows;
+		for(auto it = m_changes.begin(); it != m_changes.end(); ++it)
+		{
+			const int row = rowOf(it.key());
+			if(row < 0) continue;
+			std::sort(it.value().begin(), it.value().end());
+			rows[row] = it.value();
+		}
+		m_changes.clear();
+
+		for(auto it = rows.constBegin(); it != rows.constEnd();)
+		{
+			const int first = it.key();
+			const QVector<int> roles = it.value();
+			int last = first;
+			while(++it != rows.constEnd() && it.key() == last + 1 && it.value() == roles)
+			{
+				last++;
+			}
+			emit model->dataChanged(model->index(first, 0), model->index(last, 0), roles);
+		}
+	}
+
+private:
+	QHash<Key, QVector<int>> m_changes;
+};
@@ -0,0 +1,122 @@
+#include "rpc-cache.hpp"
+#include <QMutexLocker>
+
+RpcCache::RpcCache()
+{
+	// Add cacheable methods here, with the RPCs that change their result
+	m_policies = {
+		{"mailservers_getMailservers", {-1, {"mailservers_addMailserver", "mailservers_deleteMailserver"}}},
+		{"mailservers_getMailserverTopics", {-1, {"mailservers_addMailserverTopic", "mailservers_deleteMailserverTopic"}}},
+		{"wakuext_filters",
+		 {60000,
+		  {"wakuext_loadFilters", "wakuext_removeFilters", "wakuext_saveChat", "wakuext_createGroupChatWithMembers", "wakuext_leaveGroupChat"}}},
+		{"wallet_getCustomTokens", {-1, {"wallet_addCustomToken", "wallet_deleteCustomToken"}}},
+		{"wakuext_getLinkPreviewWhitelist", {3600000, {}}},
+		{"eth_getCode", {3600000, {}}},
+	};
+
+	for(auto it = m_policies.constBegin(); it != m_policies.constEnd(); ++it)
+	{
+		foreach(const QString& mutatingMethod, it.value().invalidatedBy)
+		{
+			m_dependents[mutatingMethod] << it.key();
+		}
+	}
+
+	m_clock.start();
+}
+
+bool RpcCache::isCached(const QString& method) const
+{
+	return m_policies.contains(method);
+}
+
+std::optional<QVariant> RpcCache::get(const QString& method, const QByteArray& key)
+{
+	if(!isCached(method)) return {};
+
+	QMutexLocker locker(&m_mutex);
+	MethodCache& cache = m_methods[method];
+	auto it = cache.entries.find(key);
+	if(it == cache.entries.end() || (it->expiresAt != -1 && it->expiresAt <= m_clock.elapsed()))
+	{
+		if(it != cache.entries.end()) cache.entries.erase(it);
+		cache.misses++;
+		return {};
+	}
+
+	cache.hits++;
+	return it->response;
+}
+
+quint64 RpcCache::generation(const QString& method) const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_methods.value(method).generation;
+}
+
+void RpcCache::put(const QString& method, const QByteArray& key, const QVariant& response, quint64 generation)
+{
+	if(!isCached(method)) return;
+
+	QMutexLocker locker(&m_mutex);
+	MethodCache& cache = m_methods[method];
+	if(cache.generation != generation) return;
+
+	if(cache.entries.size() >= MaxEntriesPerMethod && !cache.entries.contains(key))
+	{
+		cache.entries.clear();
+	}
+
+	const qint64 ttl = m_policies.value(method).ttlMs;
+	cache.entries.insert(key, Entry{response, ttl == -1 ? -1 : m_clock.elapsed() + ttl});
+}
+
+void RpcCache::invalidateBy(const QString& mutatingMethod)
+{
+	auto it = m_dependents.constFind(mutatingMethod);
+	if(it == m_dependents.constEnd()) return;
+
+	foreach(const QString& method, it.value())
+	{
+		invalidate(method);
+	}
+}
+
+void RpcCache::invalidate(const QString& method)
+{
+	QMutexLocker locker(&m_mutex);
+	MethodCache& cache = m_methods[method];
+	cache.entries.clear();
+	cache.generation++;
+	cache.invalidations++;
+}
+
+void RpcCache::clear()
+{
+	QMutexLocker locker(&m_mutex);
+	for(MethodCache& cache : m_methods)
+	{
+		cache.entries.clear();
+		cache.generation++;
+	}
+}
+
+QVariantMap RpcCache::stats() const
+{
+	QMutexLocker locker(&m_mutex);
+
+	quint64 hits = 0;
+	quint64 misses = 0;
+	QVariantMap methods;
+	for(auto it = m_methods.constBegin(); it != m_methods.constEnd(); ++it)
+	{
+		const MethodCache& cache = it.value();
+		hits += cache.hits;
+		misses += cache.misses;
+		methods[it.key()] = QVariantMap{
+			{"hits", cache.hits}, {"misses", cache.misses}, {"invalidations", cache.invalidations}, {"entries", cache.entries.size()}};
+	}
+
+	return QVariantMap{{"hits", hits}, {"misses", misses}, {"methods", methods}};
+}
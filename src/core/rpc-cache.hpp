@@ -0,0 +1,68 @@
+#pragma once
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QVariantMap>
+#include <optional>
+
+// Read-through cache for RPC responses that only change when we change them.
+// Entries are keyed by the request payload (method + params) and dropped when
+// their TTL expires, when one of the mutating methods of their policy is
+// called, or when a signal invalidates them explicitly
+class RpcCache
+{
+public:
+	struct Policy
+	{
+		qint64 ttlMs; // -1: until invalidated
+		QStringList invalidatedBy;
+	};
+
+	RpcCache();
+
+	bool isCached(const QString& method) const;
+
+	std::optional<QVariant> get(const QString& method, const QByteArray& key);
+
+	// A response is only stored if no invalidation for `method` happened since
+	// `generation` was read, so a slow read can't overwrite newer data
+	quint64 generation(const QString& method) const;
+	void put(const QString& method, const QByteArray& key, const QVariant& response, quint64 generation);
+
+	// Drops the entries of the methods whose policy lists `mutatingMethod`
+	void invalidateBy(const QString& mutatingMethod);
+	void invalidate(const QString& method);
+	void clear();
+
+	QVariantMap stats() const;
+
+private:
+	struct Entry
+	{
+		QVariant response;
+		qint64 expiresAt;
+	};
+
+	struct MethodCache
+	{
+		QHash<QByteArray, Entry> entries;
+		quint64 generation = 0;
+		quint64 hits = 0;
+		quint64 misses = 0;
+		quint64 invalidations = 0;
+	};
+
+	static const int MaxEntriesPerMethod = 256;
+
+	QHash<QString, Policy> m_policies;
+	QHash<QString, QStringList> m_dependents;
+
+	mutable QMutex m_mutex;
+	QHash<QString, MethodCache> m_methods;
+	QElapsedTimer m_clock;
+};
@@ -0,0 +1,129 @@
+#include "rpc-executor.hpp"
+#include <QMutexLocker>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrent>
+#include <algorithm>
+
+RpcExecutor::RpcExecutor(int maxConcurrency, QObject* parent)
+	: QObject(parent)
+	, m_interactiveLatencyMs(0)
+	, m_lastInteractiveAt(0)
+	, m_latencyThresholdMs(100)
+	, m_maxDeferralMs(2000)
+	, m_deferred(0)
+{
+	static const char* laneNames[LaneCount] = {"rpc-interactive", "rpc-normal", "rpc-background"};
+	for(int i = 0; i < LaneCount; i++)
+	{
+		m_lanes[i] = std::make_unique<Lane>();
+		m_lanes[i]->pool.setObjectName(laneNames[i]);
+	}
+
+	setMaxConcurrency(Interactive, 2);
+	setMaxConcurrency(Normal, maxConcurrency);
+	setMaxConcurrency(Background, 2);
+
+	m_clock.start();
+}
+
+RpcExecutor::~RpcExecutor()
+{
+	for(auto& lane : m_lanes)
+	{
+		lane->pool.waitForDone();
+	}
+}
+
+int RpcExecutor::maxConcurrency(Priority priority) const
+{
+	return m_lanes[priority]->pool.maxThreadCount();
+}
+
+void RpcExecutor::setMaxConcurrency(int value)
+{
+	setMaxConcurrency(Normal, value);
+}
+
+void RpcExecutor::setMaxConcurrency(Priority priority, int value)
+{
+	m_lanes[priority]->pool.setMaxThreadCount(std::max(1, value));
+}
+
+void RpcExecutor::enqueue(Priority priority, std::function<void()> task)
+{
+	Lane* lane = m_lanes[priority].get();
+
+	int depth;
+	{
+		QMutexLocker locker(&m_mutex);
+		depth = ++lane->pending;
+	}
+	emit queueDepthChanged(priority, depth);
+
+	const qint64 submittedAt = m_clock.elapsed();
+	QtConcurrent::run(&lane->pool, [this, priority, lane, task, submittedAt] {
+		if(priority == Background) waitForInteractiveIdle();
+
+		int depth;
+		{
+			QMutexLocker locker(&m_mutex);
+			depth = --lane->pending;
+			lane->running++;
+		}
+		emit queueDepthChanged(priority, depth);
+
+		task();
+
+		QMutexLocker locker(&m_mutex);
+		lane->running--;
+		lane->completed++;
+		if(priority == Interactive)
+		{
+			const qint64 now = m_clock.elapsed();
+			m_interactiveLatencyMs = 0.8 * m_interactiveLatencyMs + 0.2 * (now - submittedAt);
+			m_lastInteractiveAt = now;
+			if(lane->pending == 0 && lane->running == 0) m_interactiveIdle.wakeAll();
+		}
+	});
+}
+
+bool RpcExecutor::shouldDeferBackground() const
+{
+	const Lane* interactive = m_lanes[Interactive].get();
+	if(interactive->pending > 0 || interactive->running > 0) return true;
+
+	// Slow interactive calls mean libstatus is busy: give it a moment before polling again
+	return m_interactiveLatencyMs > m_latencyThresholdMs && m_clock.elapsed() - m_lastInteractiveAt < 1000;
+}
+
+void RpcExecutor::waitForInteractiveIdle()
+{
+	QMutexLocker locker(&m_mutex);
+	if(!shouldDeferBackground()) return;
+
+	// Deferral is bounded so background work can't starve
+	m_deferred++;
+	const qint64 deadline = m_clock.elapsed() + m_maxDeferralMs;
+	while(shouldDeferBackground() && m_clock.elapsed() < deadline)
+	{
+		m_interactiveIdle.wait(&m_mutex, 50);
+	}
+}
+
+QVariantMap RpcExecutor::stats() const
+{
+	static const char* laneNames[LaneCount] = {"interactive", "normal", "background"};
+
+	QMutexLocker locker(&m_mutex);
+	QVariantMap lanes;
+	for(int i = 0; i < LaneCount; i++)
+	{
+		const Lane* lane = m_lanes[i].get();
+		lanes[laneNames[i]] = QVariantMap{{"maxConcurrency", lane->pool.maxThreadCount()},
+										  {"pending", lane->pending},
+										  {"running", lane->running},
+										  {"completed", lane->completed}};
+	}
+
+	return QVariantMap{{"lanes", lanes}, {"interactiveLatencyMs", m_interactiveLatencyMs}, {"deferredBackgroundTasks", m_deferred}};
+}
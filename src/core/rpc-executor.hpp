@@ -0,0 +1,108 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QException>
+#include <QFuture>
+#include <QFutureInterface>
+#include <QMutex>
+#include <QObject>
+#include <QThreadPool>
+#include <QVariantMap>
+#include <QWaitCondition>
+#include <array>
+#include <functional>
+#include <memory>
+#include <type_traits>
+
+// Dedicated thread pools for calls into libstatus, so RPCs don't compete with
+// the global QThreadPool and never run on the UI thread.
+// Work is split in priority lanes, each with its own concurrency limit.
+// Background work is held back while interactive calls are running, or while
+// they have recently been slow, so polling never delays a user action
+class RpcExecutor : public QObject
+{
+	Q_OBJECT
+
+public:
+	enum Priority
+	{
+		Interactive,
+		Normal,
+		Background
+	};
+	Q_ENUM(Priority)
+
+	explicit RpcExecutor(int maxConcurrency, QObject* parent = nullptr);
+	~RpcExecutor();
+
+	int maxConcurrency(Priority priority = Normal) const;
+	void setMaxConcurrency(int value);
+	void setMaxConcurrency(Priority priority, int value);
+
+	template <typename Func>
+	auto run(Func func) -> QFuture<decltype(func())>
+	{
+		return run(Normal, func);
+	}
+
+	template <typename Func>
+	auto run(Priority priority, Func func) -> QFuture<decltype(func())>
+	{
+		using T = decltype(func());
+		auto promise = std::make_shared<QFutureInterface<T>>();
+		promise->reportStarted();
+		enqueue(priority, [promise, func]() {
+			try
+			{
+				if constexpr(std::is_void_v<T>)
+				{
+					func();
+				}
+				else
+				{
+					promise->reportResult(func());
+				}
+			}
+			catch(...)
+			{
+				promise->reportException(QUnhandledException());
+			}
+			promise->reportFinished();
+		});
+		return promise->future();
+	}
+
+	QVariantMap stats() const;
+
+signals:
+	// Tasks submitted to a lane and not started yet. Emitted from any thread
+	void queueDepthChanged(Priority priority, int depth);
+
+private:
+	struct Lane
+	{
+		QThreadPool pool;
+		int pending = 0;
+		int running = 0;
+		quint64 completed = 0;
+	};
+
+	static const int LaneCount = 3;
+
+	void enqueue(Priority priority, std::function<void()> task);
+	void waitForInteractiveIdle();
+	bool shouldDeferBackground() const;
+
+	std::array<std::unique_ptr<Lane>, LaneCount> m_lanes;
+
+	mutable QMutex m_mutex;
+	QWaitCondition m_interactiveIdle;
+	QElapsedTimer m_clock;
+
+	// Moving average of the interactive latency, from submission to completion
+	double m_interactiveLatencyMs;
+	qint64 m_lastInteractiveAt;
+	double m_latencyThresholdMs;
+	qint64 m_maxDeferralMs;
+	quint64 m_deferred;
+};
@@ -0,0 +1,120 @@
+#include "rpc-stats.hpp"
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QThread>
+#include <algorithm>
+#include <cmath>
+
+RpcStats::RpcStats(QObject* parent)
+	: QObject(parent)
+	, m_enabled(qEnvironmentVariableIsSet("STATUS_RPC_STATS") || qEnvironmentVariableIsSet("STATUS_RPC_STATS_FILE"))
+{
+	const QString dumpPath = qEnvironmentVariable("STATUS_RPC_STATS_FILE");
+	if(!dumpPath.isEmpty() && QCoreApplication::instance() != nullptr)
+	{
+		QObject::connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, [this, dumpPath] { dump(dumpPath); });
+	}
+}
+
+void RpcStats::setEnabled(bool value)
+{
+	m_enabled = value;
+}
+
+int RpcStats::bucket(qint64 elapsedNs)
+{
+	if(elapsedNs < 1000) return 0;
+	return std::min(BucketCount - 1, static_cast<int>(std::log2(elapsedNs / 1000.0) * 2) + 1);
+}
+
+double RpcStats::percentile(const MethodStats& stats, double p)
+{
+	// Upper bound of the bucket containing the percentile, in ms
+	quint64 target = std::max<quint64>(1, static_cast<quint64>(std::ceil(stats.calls * p)));
+	quint64 seen = 0;
+	for(int i = 0; i < BucketCount; i++)
+	{
+		seen += stats.buckets[i];
+		if(seen >= target)
+		{
+			double upperNs = 1000.0 * std::pow(2.0, i / 2.0);
+			return std::min(upperNs, static_cast<double>(stats.maxNs)) / 1e6;
+		}
+	}
+	return stats.maxNs / 1e6;
+}
+
+void RpcStats::record(const QString& method, qint64 elapsedNs, int requestBytes, int responseBytes, bool isError)
+{
+	QThread* thread = QThread::currentThread();
+	const bool onUiThread = QCoreApplication::instance() != nullptr && thread == QCoreApplication::instance()->thread();
+	const QString threadName = onUiThread ? QStringLiteral("ui") : thread->objectName().isEmpty() ? QStringLiteral("unnamed") : thread->objectName();
+
+	QMutexLocker locker(&m_mutex);
+	MethodStats& stats = m_methods[method];
+	stats.calls++;
+	if(isError) stats.errors++;
+	if(onUiThread) stats.uiThreadCalls++;
+	stats.totalNs += elapsedNs;
+	stats.maxNs = std::max(stats.maxNs, elapsedNs);
+	stats.requestBytes += requestBytes;
+	stats.responseBytes += responseBytes;
+	stats.maxResponseBytes = std::max(stats.maxResponseBytes, responseBytes);
+	stats.buckets[bucket(elapsedNs)]++;
+	stats.threads[threadName]++;
+}
+
+QVariantMap RpcStats::snapshot() const
+{
+	QMutexLocker locker(&m_mutex);
+
+	QVariantMap methods;
+	for(auto it = m_methods.constBegin(); it != m_methods.constEnd(); ++it)
+	{
+		const MethodStats& stats = it.value();
+
+		QVariantMap threads;
+		for(auto t = stats.threads.constBegin(); t != stats.threads.constEnd(); ++t)
+		{
+			threads[t.key()] = t.value();
+		}
+
+		methods[it.key()] = QVariantMap{{"calls", stats.calls},
+										{"errors", stats.errors},
+										{"uiThreadCalls", stats.uiThreadCalls},
+										{"totalMs", stats.totalNs / 1e6},
+										{"meanMs", stats.totalNs / 1e6 / stats.calls},
+										{"maxMs", stats.maxNs / 1e6},
+										{"p50Ms", percentile(stats, 0.50)},
+										{"p95Ms", percentile(stats, 0.95)},
+										{"p99Ms", percentile(stats, 0.99)},
+										{"requestBytes", stats.requestBytes},
+										{"responseBytes", stats.responseBytes},
+										{"maxResponseBytes", stats.maxResponseBytes},
+										{"threads", threads}};
+	}
+
+	return QVariantMap{{"enabled", enabled()}, {"methods", methods}};
+}
+
+void RpcStats::reset()
+{
+	QMutexLocker locker(&m_mutex);
+	m_methods.clear();
+}
+
+bool RpcStats::dump(const QString& path) const
+{
+	QFile file(path);
+	if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		qWarning() << "Could not write RPC stats to" << path << file.errorString();
+		return false;
+	}
+	file.write(QJsonDocument(QJsonObject::fromVariantMap(snapshot())).toJson());
+	return true;
+}
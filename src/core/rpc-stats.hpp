@@ -0,0 +1,57 @@
+#pragma once
+
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QVariantMap>
+#include <array>
+#include <atomic>
+
+// Per-method latency and payload size counters for libstatus RPC calls.
+// Disabled unless STATUS_RPC_STATS is set; the only cost is then an atomic load
+// per call. When STATUS_RPC_STATS_FILE is set, a JSON snapshot is written there on exit
+class RpcStats : public QObject
+{
+	Q_OBJECT
+
+public:
+	explicit RpcStats(QObject* parent = nullptr);
+
+	bool enabled() const
+	{
+		return m_enabled.load(std::memory_order_relaxed);
+	}
+	void setEnabled(bool value);
+
+	void record(const QString& method, qint64 elapsedNs, int requestBytes, int responseBytes, bool isError);
+
+	QVariantMap snapshot() const;
+	void reset();
+	bool dump(const QString& path) const;
+
+private:
+	// Latency buckets are half an octave wide, starting at 1µs
+	static constexpr int BucketCount = 64;
+
+	struct MethodStats
+	{
+		quint64 calls = 0;
+		quint64 errors = 0;
+		quint64 uiThreadCalls = 0;
+		qint64 totalNs = 0;
+		qint64 maxNs = 0;
+		quint64 requestBytes = 0;
+		quint64 responseBytes = 0;
+		int maxResponseBytes = 0;
+		std::array<quint32, BucketCount> buckets{};
+		QHash<QString, quint64> threads;
+	};
+
+	static int bucket(qint64 elapsedNs);
+	static double percentile(const MethodStats& stats, double p);
+
+	std::atomic<bool> m_enabled;
+	mutable QMutex m_mutex;
+	QHash<QString, MethodStats> m_methods;
+};
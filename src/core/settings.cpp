@@ -277,10 +277,8 @@ bool Settings::isMnemonicBackedUp() const
 
 QString Settings::getLinkPreviewWhitelist() const
 {
-	QJsonObject obj{{"method", "wakuext_getLinkPreviewWhitelist"}, {"params", QJsonArray{}}};
-	const char* result = CallPrivateRPC(Utils::jsonToStr(obj).toUtf8().data());
-	QJsonArray whiteList = QJsonDocument::fromJson(result).object()["result"].toArray();
-	return Utils::jsonToStr(whiteList);
+	const auto response = Status::instance()->callPrivateRPC("wakuext_getLinkPreviewWhitelist", QJsonArray{}.toVariantList()).toJsonObject();
+	return Utils::jsonToStr(response["result"].toArray());
 }
 
 QJsonObject Settings::getNodeConfig() const
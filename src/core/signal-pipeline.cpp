@@ -0,0 +1,194 @@
+#include "signal-pipeline.hpp"
+#include "json-uint64.hpp"
+#include <QByteArray>
+#include <QDebug>
+#include <QHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QSet>
+#include <QThread>
+#include <QVariantMap>
+#include <algorithm>
+
+namespace
+{
+
+// Signals that only carry the latest state, and can be skipped when a lane is
+// full. Every other signal is queued past the capacity and counted as stalled
+const QSet<QByteArray> droppableSignals{"discovery.summary"};
+
+QByteArray peekSignalType(const QByteArray& payload)
+{
+	// status-go serializes the signal envelope as {"type": ..., "event": ...}
+	static const QByteArray typeKey("\"type\":\"");
+	int start = payload.indexOf(typeKey);
+	if(start == -1) return QByteArray();
+	start += typeKey.size();
+	int end = payload.indexOf('"', start);
+	if(end == -1) return QByteArray();
+	return payload.mid(start, end - start);
+}
+
+} // namespace
+
+SignalPipeline::SignalPipeline(int workerCount, int capacity, QObject* parent)
+	: QObject(parent)
+	, m_laneCapacity(std::max(1, capacity / std::max(1, workerCount)))
+	, m_stopping(false)
+	, m_decodedCapacity(std::max(1, capacity))
+	, m_depth(0)
+	, m_highWaterMark(0)
+	, m_received(0)
+	, m_processed(0)
+	, m_dropped(0)
+	, m_stalled(0)
+	, m_batches(0)
+{
+	for(int i = 0; i < std::max(1, workerCount); i++)
+	{
+		auto lane = std::make_unique<Lane>();
+		Lane* l = lane.get();
+		lane->worker = QThread::create([this, l] { decodeLoop(l); });
+		lane->worker->setObjectName(QStringLiteral("signal-decoder-%1").arg(i));
+		m_lanes.push_back(std::move(lane));
+	}
+
+	for(auto& lane : m_lanes)
+	{
+		lane->worker->start();
+	}
+}
+
+SignalPipeline::~SignalPipeline()
+{
+	m_stopping = true;
+	for(auto& lane : m_lanes)
+	{
+		{
+			QMutexLocker locker(&lane->mutex);
+			lane->notEmpty.wakeAll();
+		}
+		{
+			QMutexLocker locker(&m_decodedMutex);
+			m_decodedNotFull.wakeAll();
+		}
+		lane->worker->wait();
+		delete lane->worker;
+	}
+}
+
+void SignalPipeline::push(const QByteArray& payload)
+{
+	if(m_stopping) return;
+
+	m_received++;
+
+	const QByteArray signalType = peekSignalType(payload);
+	Lane* lane = m_lanes[qHash(signalType) % m_lanes.size()].get();
+
+	QMutexLocker locker(&lane->mutex);
+	if(lane->queue.size() >= m_laneCapacity)
+	{
+		if(droppableSignals.contains(signalType))
+		{
+			m_dropped++;
+			return;
+		}
+
+		// Never wait here: this is a status-go goroutine, which may hold a lock that
+		// an RPC from the UI thread is waiting on. The lane grows past its capacity
+		m_stalled++;
+	}
+
+	lane->queue.enqueue(payload);
+	updateHighWaterMark(++m_depth);
+	lane->notEmpty.wakeOne();
+}
+
+void SignalPipeline::decodeLoop(Lane* lane)
+{
+	while(true)
+	{
+		QByteArray payload;
+		{
+			QMutexLocker locker(&lane->mutex);
+			while(lane->queue.isEmpty() && !m_stopping)
+			{
+				lane->notEmpty.wait(&lane->mutex);
+			}
+			if(m_stopping) return;
+
+			payload = lane->queue.dequeue();
+			m_depth--;
+		}
+
+		// WARNING: Signals are returning bigints as numeric values instead of strings
+		const QJsonObject signalEvent = QJsonDocument::fromJson(JsonUint64::quote(payload)).object();
+		m_processed++;
+
+		QMutexLocker locker(&m_decodedMutex);
+		if(m_decoded.size() >= m_decodedCapacity)
+		{
+			// The UI thread is behind. Skip what only carries the latest state, wait
+			// for flush() otherwise. Signals keep queuing in the lane meanwhile, as
+			// push() never waits
+			if(droppableSignals.contains(signalEvent["type"].toString().toUtf8()))
+			{
+				m_dropped++;
+				continue;
+			}
+
+			m_stalled++;
+			while(m_decoded.size() >= m_decodedCapacity && !m_stopping)
+			{
+				m_decodedNotFull.wait(&m_decodedMutex);
+			}
+			if(m_stopping) return;
+		}
+
+		m_decoded << signalEvent;
+		if(m_decoded.size() == 1)
+		{
+			// First signal of a new batch. Everything decoded until the UI thread
+			// gets to flush() is delivered together
+			QMetaObject::invokeMethod(this, &SignalPipeline::flush, Qt::QueuedConnection);
+		}
+	}
+}
+
+void SignalPipeline::flush()
+{
+	QVector<QJsonObject> batch;
+	{
+		QMutexLocker locker(&m_decodedMutex);
+		batch.swap(m_decoded);
+		m_decodedNotFull.wakeAll();
+	}
+
+	if(batch.isEmpty()) return;
+
+	m_batches++;
+	emit signalsDecoded(batch);
+}
+
+void SignalPipeline::updateHighWaterMark(int depth)
+{
+	int current = m_highWaterMark;
+	while(depth > current && !m_highWaterMark.compare_exchange_weak(current, depth))
+	{ }
+}
+
+QVariantMap SignalPipeline::stats() const
+{
+	return QVariantMap{{"workers", static_cast<int>(m_lanes.size())},
+					   {"capacity", m_laneCapacity * static_cast<int>(m_lanes.size())},
+					   {"depth", m_depth.load()},
+					   {"decodedCapacity", m_decodedCapacity},
+					   {"highWaterMark", m_highWaterMark.load()},
+					   {"received", m_received.load()},
+					   {"processed", m_processed.load()},
+					   {"dropped", m_dropped.load()},
+					   {"stalled", m_stalled.load()},
+					   {"batches", m_batches.load()}};
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QMutex>
+#include <QObject>
+#include <QQueue>
+#include <QThread>
+#include <QVariantMap>
+#include <QVector>
+#include <QWaitCondition>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// Decodes libstatus signals off the UI thread and hands them back in batches.
+// Each signal type is always routed to the same worker, so signals of the same
+// type are delivered in the order status-go emitted them. The libstatus thread
+// is never held back: past the capacity, signals are dropped when droppable and
+// queued and counted as stalled otherwise
+class SignalPipeline : public QObject
+{
+	Q_OBJECT
+
+public:
+	explicit SignalPipeline(int workerCount = 1, int capacity = 4096, QObject* parent = nullptr);
+	~SignalPipeline();
+
+	// Called from the libstatus callback thread. Doesn't wait for the workers
+	void push(const QByteArray& payload);
+
+	QVariantMap stats() const;
+
+signals:
+	void signalsDecoded(QVector<QJsonObject> signalEvents);
+
+private:
+	struct Lane
+	{
+		QQueue<QByteArray> queue;
+		QMutex mutex;
+		QWaitCondition notEmpty;
+		QThread* worker;
+	};
+
+	void decodeLoop(Lane* lane);
+	void flush();
+	void updateHighWaterMark(int depth);
+
+	std::vector<std::unique_ptr<Lane>> m_lanes;
+	int m_laneCapacity;
+	std::atomic<bool> m_stopping;
+
+	// Decoded signals waiting for the UI thread, bounded like the lanes
+	QMutex m_decodedMutex;
+	QWaitCondition m_decodedNotFull;
+	QVector<QJsonObject> m_decoded;
+	int m_decodedCapacity;
+
+	std::atomic<int> m_depth;
+	std::atomic<int> m_highWaterMark;
+	std::atomic<quint64> m_received;
+	std::atomic<quint64> m_processed;
+	std::atomic<quint64> m_dropped;
+	std::atomic<quint64> m_stalled;
+	std::atomic<quint64> m_batches;
+};
@@ -0,0 +1,45 @@
+#include "single-flight.hpp"
+#include <QMutexLocker>
+
+SingleFlight::SingleFlight()
+	: m_calls(0)
+	, m_merged(0)
+{ }
+
+QByteArray SingleFlight::run(const QByteArray& key, const std::function<QByteArray()>& call)
+{
+	QMutexLocker locker(&m_mutex);
+	m_calls++;
+
+	auto it = m_flights.constFind(key);
+	if(it != m_flights.constEnd())
+	{
+		std::shared_ptr<Flight> flight = it.value();
+		flight->waiters++;
+		m_merged++;
+		while(!flight->finished)
+		{
+			m_finished.wait(&m_mutex);
+		}
+		return flight->result;
+	}
+
+	auto flight = std::make_shared<Flight>();
+	m_flights.insert(key, flight);
+	locker.unlock();
+
+	QByteArray result = call();
+
+	locker.relock();
+	flight->result = result;
+	flight->finished = true;
+	m_flights.remove(key);
+	if(flight->waiters > 0) m_finished.wakeAll();
+
+	return result;
+}
+
+QVariantMap SingleFlight::stats() const
+{
+	return QVariantMap{{"calls", m_calls.load()}, {"merged", m_merged.load()}};
+}
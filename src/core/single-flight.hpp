@@ -0,0 +1,38 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QVariantMap>
+#include <QWaitCondition>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+// Merges identical calls that are in flight at the same time: the first caller
+// runs the call, everyone else arriving before it finishes waits for and gets
+// the same result
+class SingleFlight
+{
+public:
+	SingleFlight();
+
+	QByteArray run(const QByteArray& key, const std::function<QByteArray()>& call);
+
+	QVariantMap stats() const;
+
+private:
+	struct Flight
+	{
+		bool finished = false;
+		int waiters = 0;
+		QByteArray result;
+	};
+
+	QMutex m_mutex;
+	QWaitCondition m_finished;
+	QHash<QByteArray, std::shared_ptr<Flight>> m_flights;
+
+	std::atomic<quint64> m_calls;
+	std::atomic<quint64> m_merged;
+};
@@ -2,23 +2,54 @@
 #include "status.hpp"
 #include "QrCode.hpp"
 #include "constants.hpp"
+#include "json-uint64.hpp"
 #include "libstatus.h"
+#include "rpc-cache.hpp"
+#include "rpc-executor.hpp"
+#include "rpc-stats.hpp"
 #include "settings.hpp"
+#include "signal-pipeline.hpp"
+#include "single-flight.hpp"
 #include "utils.hpp"
 #include <QCoreApplication>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QFileInfo>
 #include <QFuture>
 #include <QFutureWatcher>
+#include <QHash>
+#include <QSet>
 #include <QJSEngine>
+#include <QJsonArray>
+#include <QJsonDocument>
 #include <QStandardPaths>
 #include <QString>
 #include <QStringList>
 #include <QTextDocumentFragment>
+#include <QThread>
+#include <QTimer>
 #include <QVariant>
 #include <QtConcurrent/QtConcurrent>
 
 std::map<QString, Status::SignalType> Status::signalMap;
+
+// Read-only methods. Identical calls to these made while one is already in
+// flight share its response instead of crossing into status-go again
+static const QSet<QString> singleFlightMethods{"accounts_getAccounts",
+											   "eth_call",
+											   "eth_gasPrice",
+											   "eth_getBalance",
+											   "mailservers_getMailservers",
+											   "mailservers_getMailserverTopics",
+											   "settings_getSettings",
+											   "wakuext_chatMessages",
+											   "wakuext_chats",
+											   "wakuext_contacts",
+											   "wakuext_emojiReactionsByChatID",
+											   "wakuext_filters",
+											   "wakuext_getOurInstallations",
+											   "wallet_getCustomTokens",
+											   "web3_clientVersion"};
 Status* Status::theInstance;
 
 Status* Status::instance()
@@ -32,6 +63,19 @@ Status::Status(QObject* parent)
 	: QObject(parent)
 {
 	m_online = false;
+	m_messageBatchWindow = 16; // One frame at 60Hz
+
+	m_messageBatchTimer = new QTimer(this);
+	m_messageBatchTimer->setSingleShot(true);
+	QObject::connect(m_messageBatchTimer, &QTimer::timeout, this, &Status::flushMessageUpdates);
+
+	m_rpcExecutor = new RpcExecutor(QThread::idealThreadCount(), this);
+	m_rpcStats = new RpcStats(this);
+	m_singleFlight = std::make_unique<SingleFlight>();
+	m_rpcCache = std::make_unique<RpcCache>();
+
+	m_signalPipeline = new SignalPipeline(2, 4096, this);
+	QObject::connect(m_signalPipeline, &SignalPipeline::signalsDecoded, this, &Status::processSignals);
 
 	SetSignalEventCallback((void*)&Status::signalCallback);
 
@@ -53,18 +97,7 @@ Status::Status(QObject* parent)
 				 {"whisper.filter.added", SignalType::WhisperFilterAdded}};
 }
 
-void uint64ToStrReplacements(QString& input)
-{
-	input.replace(QRegularExpression(QStringLiteral("\"lastClockValue\":(\\d+)")), QStringLiteral("\"lastClockValue\":\"\\1\""));
-	input.replace(QRegularExpression(QStringLiteral("\"timestamp\":(\\d+)")), QStringLiteral("\"timestamp\":\"\\1\""));
-	input.replace(QRegularExpression(QStringLiteral("\"deletedAtClockValue\":(\\d+)")), QStringLiteral("\"deletedAtClockValue\":\"\\1\""));
-	input.replace(QRegularExpression(QStringLiteral("\"clock\":(\\d+)")), QStringLiteral("\"clock\":\"\\1\""));
-	input.replace(QRegularExpression(QStringLiteral("\"clockValue\":(\\d+)")), QStringLiteral("\"clockValue\":\"\\1\""));
-	input.replace(QRegularExpression(QStringLiteral("\"whisperTimestamp\":(\\d+)")), QStringLiteral("\"whisperTimestamp\":\"\\1\""));
-	input.replace(QRegularExpression(QStringLiteral("\"ensVerifiedAt\":(\\d+)")), QStringLiteral("\"ensVerifiedAt\":\"\\1\""));
-	input.replace(QRegularExpression(QStringLiteral("\"lastENSClockValue\":(\\d+)")), QStringLiteral("\"lastENSClockValue\":\"\\1\""));
-	input.replace(QRegularExpression(QStringLiteral("\"lastUpdated\":(\\d+)")), QStringLiteral("\"lastUpdated\":\"\\1\""));
-}
+Status::~Status() { }
 
 void Status::processDiscoverySummarySignal(const QJsonObject& signalEvent)
 {
@@ -88,12 +121,88 @@ void Status::processDiscoverySummarySignal(const QJsonObject& signalEvent)
 	emit discoverySummary(peerVector);
 }
 
-void Status::processSignal(QString ev)
+void Status::processSignals(QVector<QJsonObject> signalEvents)
 {
-	// WARNING: Signals are returning bigints as numeric values instead of strings
-	uint64ToStrReplacements(ev);
+	foreach(const QJsonObject& signalEvent, signalEvents)
+	{
+		processSignal(signalEvent);
+	}
+}
+
+void Status::queueMessageUpdate(const QJsonObject& update)
+{
+	m_pendingMessageUpdates << update;
+
+	if(m_messageBatchWindow <= 0)
+	{
+		flushMessageUpdates();
+	}
+	else if(!m_messageBatchTimer->isActive())
+	{
+		m_messageBatchTimer->start(m_messageBatchWindow);
+	}
+}
+
+void Status::flushMessageUpdates()
+{
+	m_messageBatchTimer->stop();
+
+	if(m_pendingMessageUpdates.isEmpty()) return;
+
+	QVector<QJsonObject> updates;
+	updates.swap(m_pendingMessageUpdates);
+
+	if(updates.size() == 1)
+	{
+		emit message(updates[0]);
+		return;
+	}
 
-	const QJsonObject signalEvent = QJsonDocument::fromJson(ev.toUtf8()).object();
+	// Array entries (chats, messages, contacts, reactions...) are concatenated in
+	// arrival order, any other key keeps its latest value
+	QHash<QString, QJsonArray> arrays;
+	QJsonObject merged;
+	foreach(const QJsonObject& update, updates)
+	{
+		for(auto it = update.constBegin(); it != update.constEnd(); ++it)
+		{
+			if(it.value().isArray())
+			{
+				QJsonArray& items = arrays[it.key()];
+				foreach(const QJsonValue& item, it.value().toArray())
+				{
+					items << item;
+				}
+			}
+			else
+			{
+				merged[it.key()] = it.value();
+			}
+		}
+	}
+
+	for(auto it = arrays.constBegin(); it != arrays.constEnd(); ++it)
+	{
+		merged[it.key()] = it.value();
+	}
+
+	emit message(merged);
+}
+
+int Status::messageBatchWindow() const
+{
+	return m_messageBatchWindow;
+}
+
+void Status::setMessageBatchWindow(int value)
+{
+	if(m_messageBatchWindow == value) return;
+	m_messageBatchWindow = value;
+	emit messageBatchWindowChanged();
+}
+
+void Status::processSignal(const QJsonObject& signalEvent)
+{
 	SignalType signalType(Unknown);
 	if(!signalMap.count(signalEvent["type"].toString()))
 	{
@@ -104,26 +213,38 @@ void Status::processSignal(QString ev)
 
 	signalType = signalMap[signalEvent["type"].toString()];
 
+	// Signals must not overtake the messages received before them
+	if(signalType != Message) flushMessageUpdates();
+
 	switch(signalType)
 	{
-	case NodeLogin: emit instance()->login(signalEvent["event"]["error"].toString()); break;
-	case NodeReady: emit instance()->nodeReady(signalEvent["event"]["error"].toString()); break;
-	case NodeStopped: emit instance()->nodeStopped(signalEvent["event"]["error"].toString()); break;
-	case Message: emit instance()->message(signalEvent["event"].toObject()); break;
+	case NodeLogin:
+		m_rpcCache->clear();
+		emit login(signalEvent["event"]["error"].toString());
+		break;
+	case WhisperFilterAdded: m_rpcCache->invalidate("wakuext_filters"); break;
+	case NodeReady: emit nodeReady(signalEvent["event"]["error"].toString()); break;
+	case NodeStopped: emit nodeStopped(signalEvent["event"]["error"].toString()); break;
+	case Message: queueMessageUpdate(signalEvent["event"].toObject()); break;
 	case DiscoverySummary: processDiscoverySummarySignal(signalEvent); break;
-	case EnvelopeExpired: emit instance()->updateOutgoingStatus(Utils::toStringVector(signalEvent["event"]["ids"].toArray()), false); break;
-	case EnvelopeSent: emit instance()->updateOutgoingStatus(Utils::toStringVector(signalEvent["event"]["ids"].toArray()), true); break;
+	case EnvelopeExpired: emit updateOutgoingStatus(Utils::toStringVector(signalEvent["event"]["ids"].toArray()), false); break;
+	case EnvelopeSent: emit updateOutgoingStatus(Utils::toStringVector(signalEvent["event"]["ids"].toArray()), true); break;
 	}
 }
 
 void Status::emitMessageSignal(QJsonObject ev)
 {
-	emit instance()->message(ev);
+	// RPC responses to user actions are applied right away, after any pending
+	// messages.new updates. Callers on worker threads are queued to the UI thread
+	QMetaObject::invokeMethod(this, [this, ev] {
+		flushMessageUpdates();
+		emit message(ev);
+	});
 }
 
 void Status::signalCallback(const char* data)
 {
-	QtConcurrent::run(instance(), &Status::processSignal, QString(data));
+	instance()->m_signalPipeline->push(QByteArray(data));
 }
 
 void Status::closeSession()
@@ -147,39 +268,184 @@ QVariant Status::callPrivateRPC(QString method, QVariantList params)
 {
 	qDebug() << method;
 	QJsonObject payload{{"jsonrpc", "2.0"}, {"method", method}, {"params", QJsonValue::fromVariant(params)}};
-	QString payloadStr = Utils::jsonToStr(payload);
 
 	// WARNING: uint64 are expected instead of strings.
-	payloadStr.replace(QRegularExpression(QStringLiteral("\"lastClockValue\":\\s\"(\\d+?)\"")), QStringLiteral("\"lastClockValue\":\\1"));
-	payloadStr.replace(QRegularExpression(QStringLiteral("\"timestamp\":\\s\"(\\d+?)\"")), QStringLiteral("\"timestamp\":\\1"));
-	payloadStr.replace(QRegularExpression(QStringLiteral("\"deletedAtClockValue\":\\s\"(\\d+?)\"")), QStringLiteral("\"deletedAtClockValue\":\\1"));
-	payloadStr.replace(QRegularExpression(QStringLiteral("\"clock\":\\s\"(\\d+?)\"")), QStringLiteral("\"clock\":\\1"));
-	payloadStr.replace(QRegularExpression(QStringLiteral("\"clockValue\":\\s\"(\\d+?)\"")), QStringLiteral("\"clockValue\":\\1"));
-	payloadStr.replace(QRegularExpression(QStringLiteral("\"whisperTimestamp\":\\s\"(\\d+?)\"")), QStringLiteral("\"whisperTimestamp\":\\1"));
-	payloadStr.replace(QRegularExpression(QStringLiteral("\"ensVerifiedAt\":\\s\"(\\d+?)\"")), QStringLiteral("\"ensVerifiedAt\":\\1"));
-	payloadStr.replace(QRegularExpression(QStringLiteral("\"lastENSClockValue\":\\s\"(\\d+?)\"")), QStringLiteral("\"lastENSClockValue\":\\1"));
-	payloadStr.replace(QRegularExpression(QStringLiteral("\"lastUpdated\":\\s\"(\\d+?)\"")), QStringLiteral("\"lastUpdated\":\\1"));
-
-	const char* result = CallPrivateRPC(payloadStr.toUtf8().data());
+	const QByteArray payloadStr = JsonUint64::unquote(QJsonDocument(payload).toJson(QJsonDocument::Compact));
+
+	// The payload contains both the method and the params, so it's used as the key
+	if(std::optional<QVariant> cached = m_rpcCache->get(method, payloadStr))
+	{
+		return *cached;
+	}
+	const quint64 generation = m_rpcCache->generation(method);
+
+	QElapsedTimer timer;
+	if(m_rpcStats->enabled()) timer.start();
+
+	auto call = [&payloadStr] { return QByteArray(CallPrivateRPC(const_cast<char*>(payloadStr.constData()))); };
+	const QByteArray response = singleFlightMethods.contains(method) ? m_singleFlight->run(payloadStr, call) : call();
 
 	// WARNING: Signals are returning bigints as numeric values instead of strings
-	QString r = QString(result);
-	uint64ToStrReplacements(r);
+	const QVariant variant = QJsonDocument::fromJson(JsonUint64::quote(response)).toVariant();
+	const bool isError = variant.toMap().contains("error");
+
+	if(timer.isValid())
+	{
+		m_rpcStats->record(method, timer.nsecsElapsed(), payloadStr.size(), response.size(), isError);
+	}
 
-	return QJsonDocument::fromJson(r.toUtf8()).toVariant();
+	if(!isError) m_rpcCache->put(method, payloadStr, variant, generation);
+	m_rpcCache->invalidateBy(method);
+
+	return variant;
+}
+
+QVector<QJsonObject> Status::callPrivateRPCBatch(const QVector<RpcCall>& calls)
+{
+	QVector<QJsonObject> responses(calls.size());
+	if(m_batchRejected)
+	{
+		for(int i = 0; i < calls.size(); i++)
+		{
+			responses[i] = callPrivateRPC(calls[i].method, calls[i].params).toJsonObject();
+		}
+		return responses;
+	}
+
+	// Cached responses are served as in callPrivateRPC, keyed by each call's own payload.
+	// Single flight isn't applied: the batch is already one call for all of them
+	QVector<int> batched;
+	QVector<QByteArray> keys(calls.size());
+	QVector<quint64> generations(calls.size());
+	for(int i = 0; i < calls.size(); i++)
+	{
+		if(!m_rpcCache->isCached(calls[i].method))
+		{
+			batched << i;
+			continue;
+		}
+
+		const QJsonObject request{{"jsonrpc", "2.0"}, {"method", calls[i].method}, {"params", QJsonValue::fromVariant(calls[i].params)}};
+		keys[i] = JsonUint64::unquote(QJsonDocument(request).toJson(QJsonDocument::Compact));
+		if(std::optional<QVariant> cached = m_rpcCache->get(calls[i].method, keys[i]))
+		{
+			responses[i] = cached->toJsonObject();
+			continue;
+		}
+		generations[i] = m_rpcCache->generation(calls[i].method);
+		batched << i;
+	}
+
+	if(batched.isEmpty()) return responses;
+	if(batched.size() == 1)
+	{
+		responses[batched[0]] = callPrivateRPC(calls[batched[0]].method, calls[batched[0]].params).toJsonObject();
+		return responses;
+	}
+
+	QJsonArray payload;
+	for(int b = 0; b < batched.size(); b++)
+	{
+		const RpcCall& call = calls[batched[b]];
+		payload << QJsonObject{{"jsonrpc", "2.0"}, {"id", b}, {"method", call.method}, {"params", QJsonValue::fromVariant(call.params)}};
+	}
+
+	// WARNING: uint64 are expected instead of strings.
+	const QByteArray payloadStr = JsonUint64::unquote(QJsonDocument(payload).toJson(QJsonDocument::Compact));
+
+	QElapsedTimer timer;
+	if(m_rpcStats->enabled()) timer.start();
+
+	const char* result = CallPrivateRPC(const_cast<char*>(payloadStr.constData()));
+
+	// WARNING: Signals are returning bigints as numeric values instead of strings
+	const QByteArray responseStr(result);
+	const QJsonDocument response = QJsonDocument::fromJson(JsonUint64::quote(responseStr));
+
+	if(timer.isValid())
+	{
+		// Batches are tracked as a whole, keyed by the methods they contain
+		QStringList methods;
+		foreach(int i, batched)
+		{
+			if(!methods.contains(calls[i].method)) methods << calls[i].method;
+		}
+		m_rpcStats->record("batch:" + methods.join('+'), timer.nsecsElapsed(), payloadStr.size(), responseStr.size(), !response.isArray());
+	}
+
+	if(!response.isArray())
+	{
+		// status-go takes a single request per CallPrivateRPC unless it was built with batch
+		// support. That doesn't change while the app runs, so batches aren't tried again
+		qWarning() << "JSON-RPC batches not supported by status-go, sending calls individually from now on";
+		m_batchRejected = true;
+		foreach(int i, batched)
+		{
+			responses[i] = callPrivateRPC(calls[i].method, calls[i].params).toJsonObject();
+		}
+		return responses;
+	}
+
+	QVector<bool> answered(batched.size(), false);
+	foreach(const QJsonValue& value, response.array())
+	{
+		const QJsonObject obj = value.toObject();
+		int id = obj["id"].toInt(-1);
+		if(id < 0 || id >= batched.size()) continue;
+		responses[batched[id]] = obj;
+		answered[id] = true;
+	}
+
+	for(int b = 0; b < batched.size(); b++)
+	{
+		const int i = batched[b];
+		if(!answered[b])
+		{
+			responses[i] = QJsonObject{{"jsonrpc", "2.0"},
+									   {"id", i},
+									   {"error", QJsonObject{{"code", -32603}, {"message", QStringLiteral("missing response in batch")}}}};
+			continue;
+		}
+		if(!keys[i].isEmpty() && !responses[i].contains("error"))
+		{
+			m_rpcCache->put(calls[i].method, keys[i], responses[i].toVariantMap(), generations[i]);
+		}
+	}
+
+	foreach(int i, batched)
+	{
+		m_rpcCache->invalidateBy(calls[i].method);
+	}
+
+	return responses;
 }
 
 void Status::callPrivateRPC(QString method, QVariantList params, const QJSValue& callback)
 {
-	auto* watcher = new QFutureWatcher<QVariant>(this);
-	QObject::connect(watcher, &QFutureWatcher<QVariant>::finished, this, [this, watcher, callback]() {
-		QVariant result = watcher->result();
+	callPrivateRPCAsync(method, params, this, [this, callback](QJsonObject response) {
 		QJSValue cbCopy(callback); // needed as callback is captured as const
 		QJSEngine* engine = qjsEngine(this);
-		cbCopy.call(QJSValueList{engine->toScriptValue(result)});
-		watcher->deleteLater();
+		cbCopy.call(QJSValueList{engine->toScriptValue(response.toVariantMap())});
 	});
-	watcher->setFuture(QtConcurrent::run(this, &Status::callPrivateRPC, method, params));
+}
+
+QFuture<QJsonObject> Status::callPrivateRPCAsync(QString method, QVariantList params, RpcExecutor::Priority priority)
+{
+	return m_rpcExecutor->run(priority, [this, method, params] { return callPrivateRPC(method, params).toJsonObject(); });
+}
+
+QVariantMap Status::rpcStats() const
+{
+	QVariantMap stats = m_rpcStats->snapshot();
+	stats["singleFlight"] = m_singleFlight->stats();
+	stats["cache"] = m_rpcCache->stats();
+	stats["executor"] = m_rpcExecutor->stats();
+	return stats;
+}
+
+RpcExecutor* Status::rpcExecutor() const
+{
+	return m_rpcExecutor;
 }
 
 QString Status::getNodeVersion()
@@ -188,6 +454,11 @@ QString Status::getNodeVersion()
 	return QString(response["result"].toString());
 }
 
+QVariantMap Status::signalStats() const
+{
+	return m_signalPipeline->stats();
+}
+
 bool Status::isOnline()
 {
 	return m_online;
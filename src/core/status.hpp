@@ -1,17 +1,37 @@
 #pragma once
 
+#include "rpc-executor.hpp"
+#include <QFuture>
+#include <QFutureWatcher>
 #include <QJSValue>
+#include <QJsonObject>
 #include <QObject>
 #include <QString>
 #include <QVariant>
 #include <QVariantList>
+#include <QVariantMap>
+#include <QVector>
+#include <atomic>
+#include <memory>
+
+class QTimer;
+class RpcCache;
+class RpcStats;
+class SignalPipeline;
+class SingleFlight;
+
+struct RpcCall
+{
+	QString method;
+	QVariantList params;
+};
 
 class Status : public QObject
 {
 	Q_OBJECT
 
 public:
-	~Status() { }
+	~Status();
 
 	static Status* instance();
 
@@ -44,6 +64,32 @@ public:
 
 	Q_INVOKABLE QVariant callPrivateRPC(QString method, QVariantList params);
 	Q_INVOKABLE void callPrivateRPC(QString method, QVariantList params, const QJSValue& callback);
+
+	// Runs the RPC on the RPC executor instead of the calling thread. Calls
+	// triggered by the user should stay in the Interactive lane
+	QFuture<QJsonObject> callPrivateRPCAsync(QString method, QVariantList params, RpcExecutor::Priority priority = RpcExecutor::Interactive);
+
+	// Same as above, invoking `callback` with the response on the thread of `context`.
+	// The callback is dropped if `context` is destroyed before the RPC finishes
+	template <typename Func>
+	void callPrivateRPCAsync(
+		QString method, QVariantList params, QObject* context, Func callback, RpcExecutor::Priority priority = RpcExecutor::Interactive)
+	{
+		auto* watcher = new QFutureWatcher<QJsonObject>(context);
+		QObject::connect(watcher, &QFutureWatcher<QJsonObject>::finished, context, [watcher, callback]() {
+			callback(watcher->result());
+			watcher->deleteLater();
+		});
+		watcher->setFuture(callPrivateRPCAsync(method, params, priority));
+	}
+
+	// Sends the calls to status-go as a single JSON-RPC batch, except those answered
+	// from the RPC cache. Responses are returned in the same order as `calls`.
+	// status-go only gains from this when it accepts batches: after the first
+	// rejected batch, calls are sent one by one for the rest of the session
+	QVector<QJsonObject> callPrivateRPCBatch(const QVector<RpcCall>& calls);
+
+	RpcExecutor* rpcExecutor() const;
 	Q_INVOKABLE void closeSession();
 
 	static bool isError(const QJsonObject response);
@@ -56,6 +102,20 @@ public:
 
 	Q_PROPERTY(bool IsOnline READ isOnline NOTIFY onlineStatusChanged)
 
+	// Per-method call counts, latency percentiles and payload sizes (empty
+	// unless the app was started with STATUS_RPC_STATS set), plus cache and
+	// single-flight counters
+	Q_INVOKABLE QVariantMap rpcStats() const;
+
+	// Queue depth, high-water mark and drop counters of the signal pipeline
+	Q_INVOKABLE QVariantMap signalStats() const;
+
+	// messages.new signals received within this window (in ms) are merged into
+	// a single `message` emission. 0 disables the coalescing
+	Q_PROPERTY(int MessageBatchWindow READ messageBatchWindow WRITE setMessageBatchWindow NOTIFY messageBatchWindowChanged)
+	int messageBatchWindow() const;
+	void setMessageBatchWindow(int value);
+
 signals:
 	void signal(SignalType signal);
 	void login(QString error);
@@ -67,16 +127,30 @@ signals:
 	void logout();
 
 	void onlineStatusChanged(bool connected);
+	void messageBatchWindowChanged();
 
 private:
 	static Status* theInstance;
 	explicit Status(QObject* parent = nullptr);
 	static std::map<QString, SignalType> signalMap;
 	static void signalCallback(const char* data);
-	void processSignal(QString ev);
+	void processSignals(QVector<QJsonObject> signalEvents);
+	void processSignal(const QJsonObject& signalEvent);
+	void queueMessageUpdate(const QJsonObject& update);
+	void flushMessageUpdates();
 	void processDiscoverySummarySignal(const QJsonObject& signalEvent);
 	
 	bool isOnline();
 
 	bool m_online;
+	SignalPipeline* m_signalPipeline;
+	RpcExecutor* m_rpcExecutor;
+	RpcStats* m_rpcStats;
+	std::unique_ptr<SingleFlight> m_singleFlight;
+	std::unique_ptr<RpcCache> m_rpcCache;
+	std::atomic<bool> m_batchRejected{false};
+
+	int m_messageBatchWindow;
+	QTimer* m_messageBatchTimer;
+	QVector<QJsonObject> m_pendingMessageUpdates;
 };
@@ -21,6 +21,10 @@
 #include <boost/multiprecision/cpp_dec_float.hpp>
 #include <boost/math/constants/constants.hpp>
 
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
 Utils::Utils(QObject* parent)
 	: QObject(parent)
 { }
@@ -73,6 +77,22 @@ QVector<QString> Utils::toStringVector(const QJsonArray& arr)
 	return result;
 }
 
+qint64 Utils::peakResidentKB()
+{
+#ifdef Q_OS_UNIX
+	struct rusage usage;
+	if(getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef Q_OS_MACOS
+	// Reported in bytes on macOS, in kilobytes elsewhere
+	return usage.ru_maxrss / 1024;
+#else
+	return usage.ru_maxrss;
+#endif
+#else
+	return 0;
+#endif
+}
+
 QString Utils::generateQRCode(QString publicKey)
 {
 	using namespace qrcodegen;
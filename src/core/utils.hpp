@@ -34,6 +34,9 @@ public:
 	static QString jsonToStr(QJsonArray arr);
 	static QJsonArray toJsonArray(const QVector<QString>& value);
 	static QVector<QString> toStringVector(const QJsonArray& arr);
+
+	// Highest resident set size of the process so far, 0 where it isn't available
+	static qint64 peakResidentKB();
 };
 
 static QObject* utilsProvider(QQmlEngine* engine, QJSEngine* scriptEngine)
@@ -15,6 +15,7 @@
 #include "logs.hpp"
 #include "mailserver-cycle.hpp"
 #include "mailserver-model.hpp"
+#include "message-search-model.hpp"
 #include "messages-model.hpp"
 #include "onboarding-model.hpp"
 #include "settings.hpp"
@@ -152,6 +153,7 @@ int main(int argc, char* argv[])
 	qmlRegisterType<DevicesModel>("im.status.desktop", 1, 0, "DevicesModel");
 	qmlRegisterType<StickerPacksModel>("im.status.desktop", 1, 0, "StickerPacksModel");
 	qmlRegisterType<MailserverModel>("im.status.desktop", 1, 0, "MailserverModel");
+	qmlRegisterType<MessageSearchModel>("im.status.desktop", 1, 0, "MessageSearchModel");
 	qmlRegisterType<TokenModel>("im.status.desktop", 1, 0, "TokenModel");
 	qmlRegisterType<Wallet::WalletModel>("im.status.desktop", 1, 0, "WalletModel");
 
@@ -111,7 +111,7 @@ void DevicesModel::setName(QString name)
 	{
 		m_devices[index].name = name;
 		QModelIndex idx = createIndex(index, 0);
-		dataChanged(idx, idx);
+		dataChanged(idx, idx, {Name});
 	}
 
 	emit deviceSetupChanged();
@@ -326,10 +326,21 @@ std::optional<QVector<Topic>> MailserverCycle::getMailserverTopicByChatId(QStrin
 	return {};
 }
 
+static RpcCall addMailserverTopicCall(const Topic& t)
+{
+	return RpcCall{"mailservers_addMailserverTopic",
+				   QJsonArray{QJsonObject{{"topic", t.topic},
+										  {"discovery?", t.discovery},
+										  {"negotiated?", t.negotiated},
+										  {"chat-ids", Utils::toJsonArray(t.chatIds)},
+										  {"last-request", t.lastRequest}}}
+					   .toVariantList()};
+}
+
 void MailserverCycle::removeMailserverTopicForChat(QString chatId)
 {
 	QVector<Topic> topics = getMailserverTopics();
-	QVector<Topic> topicsToUpdate;
+	QVector<RpcCall> calls;
 	foreach(Topic t, topics)
 	{
 		if(t.chatIds.contains(chatId))
@@ -337,32 +348,31 @@ void MailserverCycle::removeMailserverTopicForChat(QString chatId)
 			if(t.chatIds.count() > 1)
 			{
 				t.chatIds.remove(t.chatIds.indexOf(chatId));
-				topicsToUpdate << t;
+				calls << addMailserverTopicCall(t);
 			}
 			else
 			{
-				const auto response =
-					Status::instance()->callPrivateRPC("mailservers_deleteMailserverTopic", QJsonArray{t.topic}.toVariantList()).toJsonObject();
+				calls << RpcCall{"mailservers_deleteMailserverTopic", QJsonArray{t.topic}.toVariantList()};
 			}
 		}
 	}
 
-	if(topicsToUpdate.count() == 0) return;
-	foreach(Topic t, topicsToUpdate)
-	{
-		addMailserverTopic(t);
-	}
+	Status::instance()->callPrivateRPCBatch(calls);
 }
 
 void MailserverCycle::addMailserverTopic(Topic t)
 {
-	const auto response = Status::instance()->callPrivateRPC("mailservers_addMailserverTopic",
-															 QJsonArray{QJsonObject{{"topic", t.topic},
-																					{"discovery?", t.discovery},
-																					{"negotiated?", t.negotiated},
-																					{"chat-ids", Utils::toJsonArray(t.chatIds)},
-																					{"last-request", t.lastRequest}}}
-																 .toVariantList());
+	addMailserverTopics(QVector<Topic>{t});
+}
+
+void MailserverCycle::addMailserverTopics(QVector<Topic> topics)
+{
+	QVector<RpcCall> calls;
+	foreach(const Topic& t, topics)
+	{
+		calls << addMailserverTopicCall(t);
+	}
+	Status::instance()->callPrivateRPCBatch(calls);
 }
 
 QString MailserverCycle::generateSymKeyFromPassword()
@@ -383,7 +393,7 @@ void MailserverCycle::requestMessages(QVector<QString> topicList, qint64 fromVal
 void MailserverCycle::requestMessagesCall(
 	QVector<QString> topics, QString symKeyID, QString peer, int numberOfMessages, qint64 fromTimestamp, qint64 toTimestamp, bool force)
 {
-	QtConcurrent::run([=] {
+	Status::instance()->rpcExecutor()->run([=] {
 		qint64 toValue = QDateTime::currentDateTimeUtc().toSecsSinceEpoch();
 		qint64 fromValue = toValue - 86400;
 
@@ -456,11 +466,11 @@ void MailserverCycle::initialMailserverRequest()
 	if(!isMailserverAvailable()) return; // TODO: add a pending request
 
 	// Updating topic request date
-	foreach(Topic t, topicsToRequest)
+	for(Topic& t : topicsToRequest)
 	{
 		t.lastRequest = minRequest;
-		addMailserverTopic(t);
 	}
+	addMailserverTopics(topicsToRequest);
 
 	requestMessages(topicList, minRequest);
 	emit requestSent();
@@ -492,11 +502,11 @@ void MailserverCycle::requestMessages(QString chatId, bool isOneToOne, int earli
 	if(!isMailserverAvailable()) return; // TODO: add a pending request
 
 	// Updating topic request date
-	foreach(Topic t, topicVector)
+	for(Topic& t : topicVector)
 	{
 		t.lastRequest = from;
-		addMailserverTopic(t);
 	}
+	addMailserverTopics(topicVector);
 
 	requestMessages(topicsToRequest, from, earliestKnownMessageTimestamp);
 	emit requestSent();
@@ -521,14 +531,16 @@ void MailserverCycle::requestMessagesInLast(QString chatId, bool isOneToOne, int
 	if(!isMailserverAvailable()) return; // TODO: add a pending request
 
 	// Updating topic request date
+	QVector<Topic> topicsToUpdate;
 	foreach(Topic t, topicVector)
 	{
 		if(t.lastRequest > from)
 		{
 			t.lastRequest = from;
-			addMailserverTopic(t);
+			topicsToUpdate << t;
 		}
 	}
+	addMailserverTopics(topicsToUpdate);
 
 	requestMessages(topicsToRequest, from);
 	emit requestSent();
@@ -56,6 +56,7 @@ private:
 	bool isMailserverAvailable();
 
 	void addMailserverTopic(Topic t);
+	void addMailserverTopics(QVector<Topic> topics);
 
 	QHash<QString, MailserverStatus> nodes;
 
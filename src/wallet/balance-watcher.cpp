@@ -6,7 +6,9 @@
 #include "utils.hpp"
 #include <QDebug>
 #include <QFutureWatcher>
+#include <QJsonArray>
 #include <QJsonDocument>
+#include <QJsonObject>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QNetworkRequest>
@@ -39,14 +41,53 @@ void BalanceWatcher::fetch()
 		}
 		watcher->deleteLater();
 	});
-	watcher->setFuture(QtConcurrent::run(this, &BalanceWatcher::queryBalances));
+	watcher->setFuture(Status::instance()->rpcExecutor()->run(RpcExecutor::Background, [this] { return queryBalances(); }));
+}
+
+static RpcCall ethBalanceCall(QString address)
+{
+	return RpcCall{"eth_getBalance", QJsonArray{address, QStringLiteral("latest")}.toVariantList()};
+}
+
+static RpcCall tokenBalanceCall(QString address, QString tokenAddress)
+{
+	QString postfixedAccount = address.mid(2);
+	QJsonObject tokenBalanceOf{{"to", tokenAddress}, {"from", address}, {"data", QString("0x70a08231000000000000000000000000") + postfixedAccount}};
+	return RpcCall{"eth_call", QJsonArray{tokenBalanceOf, QStringLiteral("latest")}.toVariantList()};
+}
+
+static void setBalance(QMap<QString, QString>& balances, QString symbol, const QJsonObject& response, int decimals)
+{
+	if(!response["error"].isUndefined())
+	{
+		qWarning() << "Could not fetch balance of" << symbol << response["error"]["message"].toString();
+		return;
+	}
+
+	QString balance = response["result"].toString().mid(2);
+	balances[symbol] = Utils::wei2Token(QString::fromStdString(uint256_t(balance.toStdString()).str()), decimals);
 }
 
 QVector<AccountBalance> BalanceWatcher::queryBalances()
 {
 	QVector<AccountBalance> accountBalances;
 
-	QStringList visibleTokens = QStringList(Settings::instance()->visibleTokens().toList());
+	QVector<Token> tokens;
+	foreach(QString token, Settings::instance()->visibleTokens())
+	{
+		auto tokenData = m_tokens->token(token);
+		if(!tokenData.has_value())
+		{
+			// TODO: error handling
+			qCritical() << "NO TOKEN DATA";
+			continue;
+		}
+		tokens << tokenData.value();
+	}
+
+	// All balances are requested in a single batch: ETH first, then each token, for every account
+	QStringList addresses;
+	QVector<RpcCall> calls;
 	const auto response = Status::instance()->callPrivateRPC("accounts_getAccounts", QJsonArray{}.toVariantList()).toJsonObject();
 	foreach(QJsonValue accountJson, response["result"].toArray())
 	{
@@ -54,51 +95,28 @@ QVector<AccountBalance> BalanceWatcher::queryBalances()
 		if(accountObj["chat"].toBool() == true) continue;
 
 		QString address = accountObj["address"].toString();
-		QMap<QString, QString> balances;
-		balances["ETH"] = Utils::wei2Token(QString::fromStdString(uint256_t(getETHBalance(address).toStdString()).str()), 18);
-
-		foreach(QString token, visibleTokens)
+		addresses << address;
+		calls << ethBalanceCall(address);
+		foreach(const Token& t, tokens)
 		{
-			auto tokenData = m_tokens->token(token);
-			if(!tokenData.has_value())
-			{
-				// TODO: error handling
-				qCritical() << "NO TOKEN DATA";
-				continue;
-			}
-
-			Token t = tokenData.value();
-			balances[t.symbol] =
-				Utils::wei2Token(QString::fromStdString(uint256_t(getTokenBalance(address, t.address).toStdString()).str()), t.decimals);
+			calls << tokenBalanceCall(address, t.address);
 		}
-
-		accountBalances << AccountBalance{.address = address, .balances = balances};
 	}
 
-	return accountBalances;
-}
+	const QVector<QJsonObject> responses = Status::instance()->callPrivateRPCBatch(calls);
 
-QString BalanceWatcher::getETHBalance(QString address)
-{
-	const auto response =
-		Status::instance()->callPrivateRPC("eth_getBalance", QJsonArray{address, QStringLiteral("latest")}.toVariantList()).toJsonObject();
-	if(!response["error"].isUndefined())
+	int i = 0;
+	foreach(const QString& address, addresses)
 	{
-		throw response["error"].toString();
-	}
-	return response["result"].toString().mid(2);
-}
-
-QString BalanceWatcher::getTokenBalance(QString address, QString tokenAddress)
-{
+		QMap<QString, QString> balances;
+		setBalance(balances, "ETH", responses[i++], 18);
+		foreach(const Token& t, tokens)
+		{
+			setBalance(balances, t.symbol, responses[i++], t.decimals);
+		}
 
-	QString postfixedAccount = address.mid(2);
-	QJsonObject tokenBalanceOf{{"to", tokenAddress}, {"from", address}, {"data", QString("0x70a08231000000000000000000000000") + postfixedAccount}};
-	const auto response =
-		Status::instance()->callPrivateRPC("eth_call", QJsonArray{tokenBalanceOf, QStringLiteral("latest")}.toVariantList()).toJsonObject();
-	if(!response["error"].isUndefined())
-	{
-		throw response["error"].toString();
+		accountBalances << AccountBalance{.address = address, .balances = balances};
 	}
-	return response["result"].toString().mid(2);
+
+	return accountBalances;
 }
@@ -31,8 +31,6 @@ private:
 	TokenModel* m_tokens;
 
 	QVector<AccountBalance> queryBalances();
-	QString getETHBalance(QString address);
-	QString getTokenBalance(QString address, QString tokenAddress);
 
 signals:
 	void balanceFetched(QString address, QMap<QString, QString> balanceMap);
@@ -191,7 +191,7 @@ void TokenModel::toggle(QString tokenSymbol, QString tokenAddress, bool isCustom
 		{
 			QModelIndex idx = createIndex(i, 0);
 			m_tokens[i].isVisible = visible;
-			dataChanged(idx, idx);
+			dataChanged(idx, idx, {IsVisible});
 			break;
 		}
 	}
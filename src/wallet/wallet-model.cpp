@@ -123,7 +123,7 @@ void WalletModel::updateBalance(QString address, QMap<QString, QString> balances
 		if(m_wallets[i]->get_address() == address)
 		{
 			QModelIndex idx = createIndex(i, 0);
-			dataChanged(idx, idx);
+			dataChanged(idx, idx, {Balances});
 		}
 	}
 
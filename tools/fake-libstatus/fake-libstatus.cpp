@@ -0,0 +1,626 @@
+// Stand-in for the status-go shared library. Serves generated (or canned)
+// responses without a node, database or network, so the models can be
+// exercised under reproducible load. See README.md for the knobs.
+
+#include "libstatus.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+
+typedef void (*SignalCallback)(const char*);
+
+struct Config
+{
+	int chats;
+	int messagesPerChat;
+	int contacts;
+	int accounts;
+	int rpcLatencyUs;
+	double signalRate;
+	int signalBatch;
+	bool batches;
+	unsigned int seed;
+	std::string fixturesDir;
+};
+
+long envInt(const char* name, long defaultValue)
+{
+	const char* value = std::getenv(name);
+	return value != nullptr && *value != '\0' ? std::strtol(value, nullptr, 10) : defaultValue;
+}
+
+const Config& config()
+{
+	static const Config c{
+		static_cast<int>(envInt("FAKE_LIBSTATUS_CHATS", 20)),
+		static_cast<int>(envInt("FAKE_LIBSTATUS_MESSAGES", 200)),
+		static_cast<int>(envInt("FAKE_LIBSTATUS_CONTACTS", 50)),
+		static_cast<int>(envInt("FAKE_LIBSTATUS_ACCOUNTS", 3)),
+		static_cast<int>(envInt("FAKE_LIBSTATUS_RPC_LATENCY_US", 0)),
+		std::getenv("FAKE_LIBSTATUS_SIGNAL_RATE") != nullptr ? std::strtod(std::getenv("FAKE_LIBSTATUS_SIGNAL_RATE"), nullptr) : 0.0,
+		static_cast<int>(envInt("FAKE_LIBSTATUS_SIGNAL_BATCH", 1)),
+		envInt("FAKE_LIBSTATUS_BATCHES", 1) != 0,
+		static_cast<unsigned int>(envInt("FAKE_LIBSTATUS_SEED", 1)),
+		std::getenv("FAKE_LIBSTATUS_FIXTURES") != nullptr ? std::getenv("FAKE_LIBSTATUS_FIXTURES") : "",
+	};
+	return c;
+}
+
+// Like cgo's C.CString, results are malloc'd and owned by the caller
+char* result(const std::string& s)
+{
+	return strdup(s.c_str());
+}
+
+// Deterministic pseudo-random hex, so ids and keys are stable across runs
+std::string hex(const std::string& seed, size_t length)
+{
+	static const char digits[] = "0123456789abcdef";
+	uint64_t h = 14695981039346656037ull;
+	for(char c : seed)
+	{
+		h = (h ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+	}
+
+	std::string out;
+	out.reserve(length);
+	while(out.size() < length)
+	{
+		h ^= h >> 33;
+		h *= 0xff51afd7ed558ccdull;
+		h ^= h >> 33;
+		for(int i = 0; i < 16 && out.size() < length; i++)
+		{
+			out += digits[(h >> (i * 4)) & 0xf];
+		}
+	}
+	return out;
+}
+
+std::string quote(const std::string& s)
+{
+	std::string out = "\"";
+	for(char c : s)
+	{
+		if(c == '"' || c == '\\') out += '\\';
+		out += c;
+	}
+	return out + "\"";
+}
+
+std::string publicKey(const std::string& seed)
+{
+	return "0x04" + hex("pk" + seed, 128);
+}
+
+std::string address(const std::string& seed)
+{
+	return "0x" + hex("addr" + seed, 40);
+}
+
+std::string alias(const std::string& pk)
+{
+	static const char* adjectives[] = {"Quiet", "Brave", "Gentle", "Rapid", "Bright", "Calm", "Fuzzy", "Lively"};
+	static const char* colors[] = {"Amber", "Azure", "Crimson", "Golden", "Ivory", "Jade", "Scarlet", "Violet"};
+	static const char* animals[] = {"Otter", "Falcon", "Lynx", "Heron", "Badger", "Gecko", "Marten", "Ibis"};
+	std::string h = hex(pk, 3);
+	return std::string(adjectives[h[0] % 8]) + " " + colors[h[1] % 8] + " " + animals[h[2] % 8];
+}
+
+std::string chatId(int index)
+{
+	return "fake-chat-" + std::to_string(index);
+}
+
+int64_t nowMs()
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Minimal JSON scanning. Requests come from QJsonDocument, so they are well
+// formed; only the top level of objects and arrays needs to be walked.
+const char* skipValue(const char* p, const char* end)
+{
+	int depth = 0;
+	bool inString = false;
+	for(; p < end; p++)
+	{
+		if(inString)
+		{
+			if(*p == '\\') p++;
+			else if(*p == '"') inString = false;
+			if(!inString && depth == 0) return p + 1;
+			continue;
+		}
+		switch(*p)
+		{
+		case '"': inString = true; break;
+		case '{':
+		case '[': depth++; break;
+		case '}':
+		case ']':
+			if(depth == 0) return p;
+			if(--depth == 0) return p + 1;
+			break;
+		case ',':
+			if(depth == 0) return p;
+			break;
+		}
+	}
+	return end;
+}
+
+// Raw elements of the JSON array starting at `p`
+std::vector<std::string> arrayElements(const char* p, const char* end)
+{
+	std::vector<std::string> elements;
+	while(p < end && *p != '[')
+		p++;
+	p++;
+	while(p < end)
+	{
+		while(p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t' || *p == ','))
+			p++;
+		if(p >= end || *p == ']') break;
+		const char* valueEnd = skipValue(p, end);
+		elements.emplace_back(p, valueEnd - p);
+		p = valueEnd;
+	}
+	return elements;
+}
+
+// Raw value of the top level `key` in the JSON object `json`, or an empty string
+std::string field(const std::string& json, const std::string& key)
+{
+	const char* p = json.data();
+	const char* end = p + json.size();
+	while(p < end && *p != '{')
+		p++;
+	p++;
+
+	while(p < end)
+	{
+		while(p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t' || *p == ','))
+			p++;
+		if(p >= end || *p != '"') break;
+
+		const char* keyEnd = skipValue(p, end);
+		const bool match = std::string(p + 1, std::max<ptrdiff_t>(0, keyEnd - p - 2)) == key;
+
+		p = keyEnd;
+		while(p < end && (*p == ' ' || *p == ':'))
+			p++;
+		const char* valueEnd = skipValue(p, end);
+		if(match) return std::string(p, valueEnd - p);
+		p = valueEnd;
+	}
+	return "";
+}
+
+std::string unquote(const std::string& value)
+{
+	if(value.size() < 2 || value.front() != '"') return value;
+	return value.substr(1, value.size() - 2);
+}
+
+std::string message(const std::string& chat, int64_t clock, int64_t timestamp, int authorIndex, const std::string& text)
+{
+	const std::string from = publicKey("contact" + std::to_string(authorIndex));
+	std::ostringstream out;
+	out << "{\"id\":\"0x" << hex(chat + std::to_string(clock), 64) << "\",\"chatId\":" << quote(chat) << ",\"localChatId\":" << quote(chat)
+		<< ",\"from\":" << quote(from) << ",\"alias\":" << quote(alias(from)) << ",\"identicon\":\"\",\"ensName\":\"\""
+		<< ",\"clock\":" << clock << ",\"timestamp\":" << timestamp << ",\"whisperTimestamp\":" << timestamp << ",\"text\":" << quote(text)
+		<< ",\"parsedText\":[{\"type\":\"paragraph\",\"children\":[{\"literal\":" << quote(text) << "}]}]"
+		<< ",\"contentType\":1,\"messageType\":2,\"lineCount\":1,\"rtl\":false,\"new\":false,\"seen\":true,\"outgoingStatus\":\"\"}";
+	return out.str();
+}
+
+// History messages of a chat are numbered from 0 (oldest) to messagesPerChat - 1
+int64_t historyTimestamp(int index)
+{
+	return 1600000000000ll + index * 60000ll;
+}
+
+std::string historyMessage(const std::string& chat, int index)
+{
+	const int64_t timestamp = historyTimestamp(index);
+	return message(chat, timestamp * 1000, timestamp, index % std::max(1, config().contacts), "Message " + std::to_string(index) + " in " + chat);
+}
+
+// Same format as status-go: the clock zero padded to 64 digits, followed by the
+// message id. A cursor includes the message it points to
+std::string historyCursor(const std::string& chat, int index)
+{
+	const int64_t clock = historyTimestamp(index) * 1000;
+	const std::string digits = std::to_string(clock);
+	return std::string(64 - digits.size(), '0') + digits + "0x" + hex(chat + std::to_string(clock), 64);
+}
+
+int historyIndex(const std::string& cursor)
+{
+	const int64_t clock = std::atoll(cursor.substr(0, 64).c_str());
+	return static_cast<int>((clock / 1000 - historyTimestamp(0)) / 60000ll);
+}
+
+std::string chat(int index)
+{
+	const std::string id = chatId(index);
+	std::ostringstream out;
+	out << "{\"id\":" << quote(id) << ",\"name\":" << quote(id) << ",\"color\":\"#4360df\",\"active\":true,\"chatType\":2"
+		<< ",\"timestamp\":" << 1600000000000ll + index << ",\"lastClockValue\":" << 1600000000000000ll + index
+		<< ",\"deletedAtClockValue\":0,\"unviewedMessagesCount\":0,\"muted\":false,\"identicon\":\"\"";
+	if(config().messagesPerChat > 0)
+	{
+		out << ",\"lastMessage\":" << historyMessage(id, config().messagesPerChat - 1);
+	}
+	out << "}";
+	return out.str();
+}
+
+std::string chats()
+{
+	std::string out = "[";
+	for(int i = 0; i < config().chats; i++)
+	{
+		if(i > 0) out += ",";
+		out += chat(i);
+	}
+	return out + "]";
+}
+
+std::string chatMessages(const std::vector<std::string>& params)
+{
+	const std::string chat = params.size() > 0 ? unquote(params[0]) : "";
+	const std::string cursor = params.size() > 1 ? unquote(params[1]) : "";
+	const int limit = params.size() > 2 ? std::atoi(params[2].c_str()) : 20;
+
+	int from = cursor.empty() ? config().messagesPerChat - 1 : std::min(config().messagesPerChat - 1, historyIndex(cursor));
+	int to = std::max(0, from - limit + 1);
+
+	std::string out = "{\"messages\":[";
+	for(int i = from; i >= to; i--)
+	{
+		if(i != from) out += ",";
+		out += historyMessage(chat, i);
+	}
+	out += "],\"cursor\":" + quote(to > 0 ? historyCursor(chat, to - 1) : "") + "}";
+	return out;
+}
+
+std::string contacts()
+{
+	std::string out = "[";
+	for(int i = 0; i < config().contacts; i++)
+	{
+		const std::string pk = publicKey("contact" + std::to_string(i));
+		if(i > 0) out += ",";
+		out += "{\"id\":" + quote(pk) + ",\"address\":" + quote(address("contact" + std::to_string(i))) + ",\"name\":\"\",\"alias\":" +
+			   quote(alias(pk)) + ",\"identicon\":\"\",\"ensVerified\":false,\"lastUpdated\":" + std::to_string(1600000000000ll + i) +
+			   ",\"systemTags\":[\":contact/added\"]}";
+	}
+	return out + "]";
+}
+
+std::string accounts()
+{
+	std::string out = "[{\"address\":" + quote(address("chat")) + ",\"chat\":true,\"name\":\"Chat account\",\"public-key\":" +
+					  quote(publicKey("self")) + "}";
+	for(int i = 0; i < config().accounts; i++)
+	{
+		out += ",{\"address\":" + quote(address("wallet" + std::to_string(i))) + ",\"chat\":false,\"wallet\":" + (i == 0 ? "true" : "false") +
+			   ",\"name\":\"Account " + std::to_string(i) + "\",\"color\":\"#4360df\",\"type\":\"generated\",\"path\":\"m/44'/60'/0'/0/" +
+			   std::to_string(i) + "\",\"public-key\":" + quote(publicKey("wallet" + std::to_string(i))) + "}";
+	}
+	return out + "]";
+}
+
+std::string settings()
+{
+	return "{\"public-key\":" + quote(publicKey("self")) + ",\"key-uid\":" + quote("0x" + hex("keyuid", 64)) +
+		   ",\"currency\":\"usd\",\"preferred-name\":\"\",\"mnemonic\":\"\",\"appearance\":0,\"networks/current-network\":\"mainnet_rpc\"" +
+		   ",\"networks/networks\":[],\"installation-id\":" + quote(hex("installation", 32)) + ",\"fleet\":\"eth.prod\"" +
+		   ",\"wallet-root-address\":" + quote(address("wallet-root")) + ",\"signing-phrase\":\"fake fake fake\"" +
+		   ",\"stickers/packs-installed\":{},\"stickers/recent-stickers\":[],\"usernames\":[],\"pinned-mailservers\":{}" +
+		   ",\"wallet/visible-tokens\":{},\"latest-derived-path\":0}";
+}
+
+// Canned result for `method` from FAKE_LIBSTATUS_FIXTURES/<method>.json, if any
+bool fixture(const std::string& method, std::string& out)
+{
+	if(config().fixturesDir.empty()) return false;
+
+	static std::mutex mutex;
+	static std::unordered_map<std::string, std::pair<bool, std::string>> cache;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	auto it = cache.find(method);
+	if(it == cache.end())
+	{
+		std::ifstream file(config().fixturesDir + "/" + method + ".json");
+		std::stringstream buffer;
+		if(file) buffer << file.rdbuf();
+		it = cache.emplace(method, std::make_pair(static_cast<bool>(file), buffer.str())).first;
+	}
+	if(!it->second.first) return false;
+	out = it->second.second;
+	return true;
+}
+
+std::string resultFor(const std::string& method, const std::vector<std::string>& params)
+{
+	std::string canned;
+	if(fixture(method, canned)) return canned;
+
+	if(method == "wakuext_chats") return chats();
+	if(method == "wakuext_chatMessages") return chatMessages(params);
+	if(method == "wakuext_contacts") return contacts();
+	if(method == "accounts_getAccounts") return accounts();
+	if(method == "settings_getSettings") return settings();
+	if(method == "web3_clientVersion") return "\"StatusIM/fake-libstatus\"";
+	if(method == "eth_getBalance") return "\"0xde0b6b3a7640000\"";
+	if(method == "eth_gasPrice") return "\"0x3b9aca00\"";
+	if(method == "eth_call") return "\"0x" + std::string(64, '0') + "\"";
+	if(method == "wakuext_emojiReactionsByChatID" || method == "wakuext_filters" || method == "mailservers_getMailserverTopics" ||
+	   method == "mailservers_getMailservers" || method == "wakuext_getOurInstallations" || method == "wallet_getCustomTokens")
+	{
+		return "[]";
+	}
+	return "null";
+}
+
+std::string handleRequest(const std::string& request)
+{
+	const std::string method = unquote(field(request, "method"));
+	const std::string rawParams = field(request, "params");
+	const std::vector<std::string> params = arrayElements(rawParams.data(), rawParams.data() + rawParams.size());
+	const std::string id = field(request, "id");
+
+	return "{\"jsonrpc\":\"2.0\"" + (id.empty() ? std::string() : ",\"id\":" + id) + ",\"result\":" + resultFor(method, params) + "}";
+}
+
+// Signals
+
+std::atomic<SignalCallback> signalCallback{nullptr};
+std::atomic<bool> generatorRunning{false};
+std::thread generator;
+std::mutex generatorMutex;
+
+void emitSignal(const std::string& type, const std::string& event)
+{
+	SignalCallback cb = signalCallback.load();
+	if(cb == nullptr) return;
+	const std::string payload = "{\"type\":" + quote(type) + ",\"event\":" + event + "}";
+	cb(payload.c_str());
+}
+
+void generateSignals()
+{
+	const Config& c = config();
+	std::mt19937 rng(c.seed);
+	std::uniform_int_distribution<int> chatDist(0, std::max(0, c.chats - 1));
+	std::uniform_int_distribution<int> authorDist(0, std::max(0, c.contacts - 1));
+
+	const auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / c.signalRate));
+	auto next = std::chrono::steady_clock::now();
+	int64_t clock = nowMs() * 1000;
+	uint64_t sequence = 0;
+
+	while(generatorRunning)
+	{
+		std::string messages;
+		for(int i = 0; i < std::max(1, c.signalBatch); i++)
+		{
+			if(i > 0) messages += ",";
+			const int64_t timestamp = nowMs();
+			clock = std::max(clock + 1, timestamp * 1000);
+			messages += message(chatId(chatDist(rng)), clock, timestamp, authorDist(rng), "Live message " + std::to_string(sequence++));
+		}
+		emitSignal("messages.new", "{\"messages\":[" + messages + "]}");
+
+		next += interval;
+		std::this_thread::sleep_until(next);
+	}
+}
+
+void startSession()
+{
+	std::lock_guard<std::mutex> lock(generatorMutex);
+	std::thread([] { emitSignal("node.login", "{}"); }).detach();
+
+	if(config().signalRate <= 0 || config().chats <= 0 || generatorRunning) return;
+	generatorRunning = true;
+	generator = std::thread(generateSignals);
+}
+
+void stopSession()
+{
+	std::lock_guard<std::mutex> lock(generatorMutex);
+	generatorRunning = false;
+	if(generator.joinable()) generator.join();
+}
+
+std::string generatedAccount(const std::string& seed, bool withMnemonic)
+{
+	return "{\"id\":" + quote(hex("id" + seed, 32)) + ",\"address\":" + quote(address(seed)) + ",\"publicKey\":" + quote(publicKey(seed)) +
+		   ",\"keyUid\":" + quote("0x" + hex("keyuid" + seed, 64)) +
+		   (withMnemonic ? ",\"mnemonic\":\"abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon about\"" : "") +
+		   "}";
+}
+
+std::string derivedAddresses(const std::string& seed, const std::string& paramsJSON)
+{
+	const std::string paths = field(paramsJSON, "paths");
+	std::string out = "{";
+	bool first = true;
+	for(const std::string& path : arrayElements(paths.data(), paths.data() + paths.size()))
+	{
+		if(!first) out += ",";
+		first = false;
+		out += path + ":{\"publicKey\":" + quote(publicKey(seed + path)) + ",\"address\":" + quote(address(seed + path)) + "}";
+	}
+	return out + "}";
+}
+
+const std::string noError = "{\"error\":\"\"}";
+
+} // namespace
+
+extern "C" {
+
+char* InitKeystore(char*)
+{
+	return result(noError);
+}
+
+char* OpenAccounts(char*)
+{
+	const std::string pk = publicKey("self");
+	return result("[{\"name\":" + quote(alias(pk)) + ",\"identicon\":\"\",\"key-uid\":" + quote("0x" + hex("keyuid", 64)) +
+				  ",\"keycard-pairing\":\"\",\"timestamp\":1600000000}]");
+}
+
+char* Login(char*, char*)
+{
+	startSession();
+	return result(noError);
+}
+
+char* SaveAccountAndLogin(char*, char*, char*, char*, char*)
+{
+	startSession();
+	return result(noError);
+}
+
+char* Logout()
+{
+	stopSession();
+	return result(noError);
+}
+
+char* VerifyAccountPassword(char*, char*, char*)
+{
+	return result(noError);
+}
+
+char* ValidateMnemonic(char*)
+{
+	return result(noError);
+}
+
+char* MultiAccountGenerateAndDeriveAddresses(char* paramsJSON)
+{
+	const std::string params(paramsJSON);
+	const std::string n = field(params, "n");
+	std::string out = "[";
+	for(int i = 0; i < (n.empty() ? 5 : std::atoi(n.c_str())); i++)
+	{
+		const std::string seed = "generated" + std::to_string(i);
+		std::string account = generatedAccount(seed, true);
+		account.pop_back();
+		if(i > 0) out += ",";
+		out += account + ",\"derived\":" + derivedAddresses(seed, params) + "}";
+	}
+	return result(out + "]");
+}
+
+char* MultiAccountDeriveAddresses(char* paramsJSON)
+{
+	const std::string params(paramsJSON);
+	return result(derivedAddresses(unquote(field(params, "accountID")), params));
+}
+
+char* MultiAccountStoreDerivedAccounts(char* paramsJSON)
+{
+	const std::string params(paramsJSON);
+	return result(derivedAddresses(unquote(field(params, "accountID")), params));
+}
+
+char* MultiAccountImportMnemonic(char* paramsJSON)
+{
+	return result(generatedAccount(unquote(field(paramsJSON, "mnemonicPhrase")), true));
+}
+
+char* MultiAccountImportPrivateKey(char* paramsJSON)
+{
+	return result(generatedAccount(unquote(field(paramsJSON, "privateKey")), false));
+}
+
+char* MultiAccountStoreAccount(char* paramsJSON)
+{
+	return result(generatedAccount(unquote(field(paramsJSON, "accountID")), false));
+}
+
+char* MultiAccountLoadAccount(char* paramsJSON)
+{
+	return result(generatedAccount(unquote(field(paramsJSON, "address")), false));
+}
+
+char* CallPrivateRPC(char* inputJSON)
+{
+	if(config().rpcLatencyUs > 0)
+	{
+		std::this_thread::sleep_for(std::chrono::microseconds(config().rpcLatencyUs));
+	}
+
+	const char* begin = inputJSON;
+	const char* end = inputJSON + std::strlen(inputJSON);
+	while(begin < end && *begin == ' ')
+		begin++;
+
+	if(begin < end && *begin == '[')
+	{
+		// Like a status-go build without batch support, which only parses a single request
+		if(!config().batches)
+		{
+			return result("{\"jsonrpc\":\"2.0\",\"id\":null,\"error\":{\"code\":-32600,\"message\":\"invalid request\"}}");
+		}
+
+		std::string out = "[";
+		bool first = true;
+		for(const std::string& request : arrayElements(begin, end))
+		{
+			if(!first) out += ",";
+			first = false;
+			out += handleRequest(request);
+		}
+		return result(out + "]");
+	}
+
+	return result(handleRequest(std::string(begin, end)));
+}
+
+char* SendTransaction(char*, char*)
+{
+	return result("{\"result\":\"0x" + hex("tx" + std::to_string(nowMs()), 64) + "\"}");
+}
+
+char* GenerateAlias(char* pk)
+{
+	return result(alias(pk));
+}
+
+char* Identicon(char*)
+{
+	// 1x1 transparent PNG
+	return result("data:image/png;base64,iVBORw0KGgoAAAANSUhEUgAAAAEAAAABCAQAAAC1HAwCAAAAC0lEQVR42mNkYAAAAAYAAjCB0C8AAAAASUVORK5CYII=");
+}
+
+void SetSignalEventCallback(void* cb)
+{
+	signalCallback = reinterpret_cast<SignalCallback>(cb);
+}
+
+} // extern "C"
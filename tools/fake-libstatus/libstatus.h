@@ -0,0 +1,36 @@
+#pragma once
+
+// Subset of the status-go C ABI used by status-cpp. Must stay in sync with the
+// header cgo generates in vendor/status-go/build/bin/libstatus.h
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern char* InitKeystore(char* keydir);
+extern char* OpenAccounts(char* datadir);
+extern char* Login(char* accountData, char* password);
+extern char* SaveAccountAndLogin(char* accountData, char* password, char* settingsJSON, char* configJSON, char* subaccountData);
+extern char* Logout();
+extern char* VerifyAccountPassword(char* keyStoreDir, char* address, char* password);
+extern char* ValidateMnemonic(char* mnemonic);
+
+extern char* MultiAccountGenerateAndDeriveAddresses(char* paramsJSON);
+extern char* MultiAccountDeriveAddresses(char* paramsJSON);
+extern char* MultiAccountStoreDerivedAccounts(char* paramsJSON);
+extern char* MultiAccountImportMnemonic(char* paramsJSON);
+extern char* MultiAccountImportPrivateKey(char* paramsJSON);
+extern char* MultiAccountStoreAccount(char* paramsJSON);
+extern char* MultiAccountLoadAccount(char* paramsJSON);
+
+extern char* CallPrivateRPC(char* inputJSON);
+extern char* SendTransaction(char* txArgsJSON, char* password);
+
+extern char* GenerateAlias(char* pk);
+extern char* Identicon(char* pk);
+
+extern void SetSignalEventCallback(void* cb);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,242 @@
+// Output and speed of JsonUint64 against the QRegularExpression passes it replaced. See README.md
+
+#include "json-uint64.hpp"
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QRegularExpression>
+#include <QStringList>
+#include <QTextStream>
+#include <QVector>
+#include <functional>
+
+namespace
+{
+
+// The rewriting as it was before, kept as the reference output
+namespace Reference
+{
+
+void uint64ToStrReplacements(QString& input)
+{
+	input.replace(QRegularExpression(QStringLiteral("\"lastClockValue\":(\\d+)")), QStringLiteral("\"lastClockValue\":\"\\1\""));
+	input.replace(QRegularExpression(QStringLiteral("\"timestamp\":(\\d+)")), QStringLiteral("\"timestamp\":\"\\1\""));
+	input.replace(QRegularExpression(QStringLiteral("\"deletedAtClockValue\":(\\d+)")), QStringLiteral("\"deletedAtClockValue\":\"\\1\""));
+	input.replace(QRegularExpression(QStringLiteral("\"clock\":(\\d+)")), QStringLiteral("\"clock\":\"\\1\""));
+	input.replace(QRegularExpression(QStringLiteral("\"clockValue\":(\\d+)")), QStringLiteral("\"clockValue\":\"\\1\""));
+	input.replace(QRegularExpression(QStringLiteral("\"whisperTimestamp\":(\\d+)")), QStringLiteral("\"whisperTimestamp\":\"\\1\""));
+	input.replace(QRegularExpression(QStringLiteral("\"ensVerifiedAt\":(\\d+)")), QStringLiteral("\"ensVerifiedAt\":\"\\1\""));
+	input.replace(QRegularExpression(QStringLiteral("\"lastENSClockValue\":(\\d+)")), QStringLiteral("\"lastENSClockValue\":\"\\1\""));
+	input.replace(QRegularExpression(QStringLiteral("\"lastUpdated\":(\\d+)")), QStringLiteral("\"lastUpdated\":\"\\1\""));
+}
+
+QByteArray quote(const QByteArray& json)
+{
+	QString r = QString(json);
+	uint64ToStrReplacements(r);
+	return r.toUtf8();
+}
+
+QByteArray request(const QJsonObject& payload)
+{
+	QString payloadStr = QString::fromUtf8(QJsonDocument(payload).toJson());
+	payloadStr.replace(QRegularExpression(QStringLiteral("\"lastClockValue\":\\s\"(\\d+?)\"")), QStringLiteral("\"lastClockValue\":\\1"));
+	payloadStr.replace(QRegularExpression(QStringLiteral("\"timestamp\":\\s\"(\\d+?)\"")), QStringLiteral("\"timestamp\":\\1"));
+	payloadStr.replace(QRegularExpression(QStringLiteral("\"deletedAtClockValue\":\\s\"(\\d+?)\"")), QStringLiteral("\"deletedAtClockValue\":\\1"));
+	payloadStr.replace(QRegularExpression(QStringLiteral("\"clock\":\\s\"(\\d+?)\"")), QStringLiteral("\"clock\":\\1"));
+	payloadStr.replace(QRegularExpression(QStringLiteral("\"clockValue\":\\s\"(\\d+?)\"")), QStringLiteral("\"clockValue\":\\1"));
+	payloadStr.replace(QRegularExpression(QStringLiteral("\"whisperTimestamp\":\\s\"(\\d+?)\"")), QStringLiteral("\"whisperTimestamp\":\\1"));
+	payloadStr.replace(QRegularExpression(QStringLiteral("\"ensVerifiedAt\":\\s\"(\\d+?)\"")), QStringLiteral("\"ensVerifiedAt\":\\1"));
+	payloadStr.replace(QRegularExpression(QStringLiteral("\"lastENSClockValue\":\\s\"(\\d+?)\"")), QStringLiteral("\"lastENSClockValue\":\\1"));
+	payloadStr.replace(QRegularExpression(QStringLiteral("\"lastUpdated\":\\s\"(\\d+?)\"")), QStringLiteral("\"lastUpdated\":\\1"));
+	return payloadStr.toUtf8();
+}
+
+} // namespace Reference
+
+QByteArray request(const QJsonObject& payload)
+{
+	return JsonUint64::unquote(QJsonDocument(payload).toJson(QJsonDocument::Compact));
+}
+
+QString hex(QRandomGenerator& rng, int length)
+{
+	static const char digits[] = "0123456789abcdef";
+	QString result("0x");
+	for(int i = 0; i < length; i++)
+	{
+		result += QChar(digits[rng.bounded(16)]);
+	}
+	return result;
+}
+
+QString text(QRandomGenerator& rng)
+{
+	static const QStringList words{"hello", "status", "gm", "anyone", "around", "ethereum", "is", "the", "best", "chat", "\"quoted\""};
+	QStringList result;
+	const int count = 1 + rng.bounded(30);
+	for(int i = 0; i < count; i++)
+	{
+		result << words[rng.bounded(words.size())];
+	}
+	return result.join(" ");
+}
+
+// Same fields, in the same order, as status-go sends them
+QString message(QRandomGenerator& rng, const QString& chatId, qint64 clock)
+{
+	const QString body = QString(QJsonDocument(QJsonArray{text(rng)}).toJson(QJsonDocument::Compact)).mid(1).chopped(1);
+	const qint64 timestamp = clock / 1000;
+	return QString("{\"id\":\"%1\",\"chatId\":\"%2\",\"localChatId\":\"%2\",\"from\":\"%3\",\"alias\":\"Some Random Alias\",\"identicon\":\"\","
+				   "\"ensName\":\"\",\"clock\":%4,\"timestamp\":%5,\"whisperTimestamp\":%5,\"text\":%6,"
+				   "\"parsedText\":[{\"type\":\"paragraph\",\"children\":[{\"literal\":%6}]}],\"contentType\":1,\"messageType\":2,"
+				   "\"lineCount\":1,\"rtl\":false,\"new\":true,\"seen\":false,\"outgoingStatus\":\"\",\"responseTo\":\"\"}")
+		.arg(hex(rng, 64), chatId, hex(rng, 130))
+		.arg(clock)
+		.arg(timestamp)
+		.arg(body);
+}
+
+QVector<QByteArray> generate(int count)
+{
+	QRandomGenerator rng(1);
+	QVector<QByteArray> payloads;
+	qint64 clock = 1600000000000000ll;
+	for(int i = 0; i < count; i++)
+	{
+		QStringList items;
+		if(i % 10 == 9)
+		{
+			// A wakuext_chats response
+			for(int c = 0; c < 50; c++)
+			{
+				items << QString("{\"id\":\"chat-%1\",\"name\":\"chat-%1\",\"color\":\"#4360df\",\"active\":true,\"chatType\":2,"
+								 "\"timestamp\":%2,\"lastClockValue\":%3,\"deletedAtClockValue\":0,\"unviewedMessagesCount\":%4,"
+								 "\"muted\":false,\"lastMessage\":%5}")
+							 .arg(c)
+							 .arg(clock / 1000)
+							 .arg(clock)
+							 .arg(rng.bounded(100))
+							 .arg(message(rng, QString("chat-%1").arg(c), clock));
+			}
+			payloads << QString("{\"jsonrpc\":\"2.0\",\"id\":0,\"result\":[%1]}").arg(items.join(",")).toUtf8();
+			continue;
+		}
+
+		const int messages = 1 + rng.bounded(50);
+		for(int m = 0; m < messages; m++)
+		{
+			clock += 1 + rng.bounded(5000);
+			items << message(rng, QString("chat-%1").arg(rng.bounded(20)), clock);
+		}
+		payloads << QString("{\"type\":\"messages.new\",\"event\":{\"chats\":[],\"messages\":[%1]}}").arg(items.join(",")).toUtf8();
+	}
+	return payloads;
+}
+
+QVector<QByteArray> load(const QString& path)
+{
+	QVector<QByteArray> payloads;
+	QDir dir(path);
+	foreach(const QString& name, dir.entryList(QDir::Files, QDir::Name))
+	{
+		QFile file(dir.filePath(name));
+		if(file.open(QIODevice::ReadOnly)) payloads << file.readAll();
+	}
+	return payloads;
+}
+
+qint64 time(int iterations, const std::function<void()>& run)
+{
+	QElapsedTimer timer;
+	timer.start();
+	for(int i = 0; i < iterations; i++)
+	{
+		run();
+	}
+	return timer.nsecsElapsed() / 1000 / iterations;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	QCoreApplication app(argc, argv);
+	const QStringList args = app.arguments();
+	const QVector<QByteArray> payloads = args.size() > 1 && !args[1].isEmpty() ? load(args[1]) : generate(200);
+	const int iterations = args.size() > 2 ? std::max(1, args[2].toInt()) : 20;
+
+	QTextStream out(stdout);
+	if(payloads.isEmpty())
+	{
+		out << "no payloads\n";
+		return 1;
+	}
+
+	qint64 bytes = 0;
+	int mismatches = 0;
+	QVector<QJsonObject> requests;
+	for(int i = 0; i < payloads.size(); i++)
+	{
+		bytes += payloads[i].size();
+
+		const QJsonDocument expected = QJsonDocument::fromJson(Reference::quote(payloads[i]));
+		const QJsonDocument actual = QJsonDocument::fromJson(JsonUint64::quote(payloads[i]));
+		if(expected != actual)
+		{
+			mismatches++;
+			out << "quote mismatch in payload " << i << "\n" << payloads[i].left(500) << "\n";
+		}
+
+		const QJsonValue param = actual.isArray() ? QJsonValue(actual.array()) : QJsonValue(actual.object());
+		const QJsonObject request{{"jsonrpc", "2.0"}, {"method", "bench"}, {"params", QJsonArray{param}}};
+		requests << request;
+		if(QJsonDocument::fromJson(Reference::request(request)) != QJsonDocument::fromJson(::request(request)))
+		{
+			mismatches++;
+			out << "unquote mismatch in payload " << i << "\n" << payloads[i].left(500) << "\n";
+		}
+	}
+
+	out << payloads.size() << " payloads, " << bytes / 1024 << " KB, " << mismatches << " mismatches\n";
+
+	const qint64 quoteOld = time(iterations, [&] {
+		for(const QByteArray& payload : payloads)
+		{
+			Reference::quote(payload);
+		}
+	});
+	const qint64 quoteNew = time(iterations, [&] {
+		for(const QByteArray& payload : payloads)
+		{
+			JsonUint64::quote(payload);
+		}
+	});
+	const qint64 requestOld = time(iterations, [&] {
+		for(const QJsonObject& request : requests)
+		{
+			Reference::request(request);
+		}
+	});
+	const qint64 requestNew = time(iterations, [&] {
+		for(const QJsonObject& request : requests)
+		{
+			::request(request);
+		}
+	});
+
+	auto report = [&](const char* name, qint64 before, qint64 after) {
+		out << name << ": regex " << before << " us, single pass " << after << " us ("
+			<< QString::number(double(before) / std::max<qint64>(1, after), 'f', 1) << "x), "
+			<< QString::number(bytes / 1024.0 / std::max<qint64>(1, after) * 1000000 / 1024, 'f', 1) << " MB/s\n";
+	};
+	report("signals and responses", quoteOld, quoteNew);
+	report("requests", requestOld, requestNew);
+
+	return mismatches > 0 ? 1 : 0;
+}
@@ -0,0 +1,368 @@
+// Output and speed of Messages::Format and the ParsedText it renders, against the QTextDocumentFragment based
+// renderer it replaced. See README.md
+
+#include "message-format.hpp"
+#include "message.hpp"
+#include "parsed-text.hpp"
+#include <QCborArray>
+#include <QCborValue>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QGuiApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QStringBuilder>
+#include <QStringList>
+#include <QTextDocumentFragment>
+#include <QTextStream>
+#include <QVector>
+#include <algorithm>
+#include <functional>
+#include <memory>
+
+namespace
+{
+
+// The renderer as it was before, kept as the reference output
+namespace Reference
+{
+
+QString renderInline(const QJsonObject& elem)
+{
+	QString value(elem["literal"].toString().toHtmlEscaped().replace("\r\n", "<br />").replace("\n", "<br />"));
+	QString textType = elem["type"].toString();
+
+	if(textType == "") return value;
+	if(textType == "code") return "<code>" % value % "</code>";
+	if(textType == "emph") return "<em>" % value % "</em>";
+	if(textType == "strong") return "<strong>" % value % "</strong>";
+	if(textType == "strong-emph") return "<strong><em>" % value % "</em></strong>";
+	if(textType == "link") return elem["destination"].toString();
+	if(textType == "mention") return "<a href=\"//" % value % "\" class=\"mention\">" % value % "</a>";
+	if(textType == "status-tag") return "<a href=\"#" % value % "\" class=\"status-tag\">#" % value % "</a>";
+	if(textType == "del") return "<del>" % value % "</del>";
+	return " " % value % " ";
+}
+
+QString renderBlock(const QJsonArray& parsedText)
+{
+	QStringList result;
+	foreach(const QJsonValue& pMsg, parsedText)
+	{
+		const QJsonObject p = pMsg.toObject();
+		QString textType = p["type"].toString();
+
+		if(textType == "paragraph")
+		{
+			QStringList inlineResult;
+			foreach(const QJsonValue& child, p["children"].toArray())
+			{
+				inlineResult << renderInline(child.toObject());
+			}
+			result << QStringLiteral("<p>") % inlineResult.join("") % QStringLiteral("</p>");
+		}
+		else if(textType == "blockquote")
+		{
+			result << QStringLiteral("<table class=\"blockquote\">") % QStringLiteral("<tr>") %
+						  QStringLiteral("<td class=\"quoteline\" valign=\"middle\"></td>") % QStringLiteral("<td>") %
+						  p["literal"].toString().toHtmlEscaped().split("\n").join("<br/>") % QStringLiteral("</td>") %
+						  QStringLiteral("</tr>") % QStringLiteral("</table>");
+		}
+		else if(textType == "codeblock")
+		{
+			result << QStringLiteral("<code>") % p["literal"].toString().toHtmlEscaped() % QStringLiteral("</code>");
+		}
+	}
+	return result.join("");
+}
+
+QString renderSimplifiedInline(const QJsonObject& elem)
+{
+	QString value(elem["literal"].toString().toHtmlEscaped().replace("\r\n", "<br />").replace("\n", "<br />"));
+	QString textType = elem["type"].toString();
+
+	if(textType == "link") return elem["destination"].toString();
+	if(textType == "mention") return value;
+	if(textType == "status-tag") return "#" % value;
+	if(textType == "" || textType == "code" || textType == "emph" || textType == "strong" || textType == "strong-emph" ||
+	   textType == "del")
+		return " " % QTextDocumentFragment::fromHtml(value).toPlainText() % " ";
+	return " " % value % " ";
+}
+
+QString renderSimpleText(const QJsonArray& parsedText)
+{
+	QStringList result;
+	foreach(const QJsonValue& pMsg, parsedText)
+	{
+		const QJsonObject p = pMsg.toObject();
+		QString textType = p["type"].toString();
+
+		if(textType == "paragraph")
+		{
+			QStringList inlineResult;
+			foreach(const QJsonValue& child, p["children"].toArray())
+			{
+				inlineResult << renderSimplifiedInline(child.toObject());
+			}
+			result << QTextDocumentFragment::fromHtml(inlineResult.join("")).toPlainText();
+		}
+		else if(textType == "blockquote" || textType == "codeblock")
+		{
+			result << QTextDocumentFragment::fromHtml(pMsg["literal"].toString()).toPlainText();
+		}
+	}
+	return result.join("");
+}
+
+} // namespace Reference
+
+QJsonObject span(const QString& type, const QString& literal)
+{
+	return QJsonObject{{"type", type}, {"literal", literal}};
+}
+
+// Shaped like the parsedText status-go sends
+QJsonArray generateParsedText(QRandomGenerator& rng)
+{
+	static const QStringList words{"status", "hello", "the", "chat", "is", "working", "fine", "today", "waku", "node", "sync",
+								   "a < b", "R&D", "\"quoted\"", "café", "👍", "  spaced  ", "line\nbreak"};
+	auto text = [&rng](int count) {
+		QStringList result;
+		for(int i = 0; i < count; i++)
+		{
+			result << words[rng.bounded(words.size())];
+		}
+		return result.join(" ");
+	};
+
+	QJsonArray blocks;
+	const int blockCount = 1 + rng.bounded(3);
+	for(int b = 0; b < blockCount; b++)
+	{
+		const int kind = rng.bounded(10);
+		if(kind == 0)
+		{
+			blocks << QJsonObject{{"type", "blockquote"}, {"literal", text(3 + rng.bounded(10))}};
+			continue;
+		}
+		if(kind == 1)
+		{
+			blocks << QJsonObject{{"type", "codeblock"}, {"literal", "int main()\n{\n\treturn 0;\n}\n"}};
+			continue;
+		}
+
+		QJsonArray children;
+		const int spanCount = 1 + rng.bounded(5);
+		for(int s = 0; s < spanCount; s++)
+		{
+			switch(rng.bounded(10))
+			{
+			case 0: children << span("strong", text(2)); break;
+			case 1: children << span("emph", text(2)); break;
+			case 2: children << span("code", text(1)); break;
+			case 3: children << span("mention", "0x04" + QString("ab").repeated(64)); break;
+			case 4:
+				children << QJsonObject{{"type", "link"}, {"literal", "https://status.im"}, {"destination", "https://status.im/?a=1&b=2"}};
+				break;
+			case 5: children << span("status-tag", "status"); break;
+			case 6: children << span("del", text(2)); break;
+			default: children << span("", text(3 + rng.bounded(15)));
+			}
+		}
+		blocks << QJsonObject{{"type", "paragraph"}, {"children", children}};
+	}
+	return blocks;
+}
+
+QVector<QJsonArray> loadCorpus(const QString& fileName)
+{
+	QFile file(fileName);
+	if(!file.open(QIODevice::ReadOnly)) return {};
+
+	QVector<QJsonArray> corpus;
+	std::function<void(const QJsonValue&)> collect = [&corpus, &collect](const QJsonValue& value) {
+		if(value.isArray())
+		{
+			foreach(const QJsonValue& item, value.toArray())
+			{
+				collect(item);
+			}
+		}
+		else if(value["parsedText"].isArray())
+		{
+			corpus << value["parsedText"].toArray();
+		}
+		else if(value["result"]["messages"].isArray())
+		{
+			collect(value["result"]["messages"]);
+		}
+	};
+	const QJsonDocument document = QJsonDocument::fromJson(file.readAll());
+	collect(document.isArray() ? QJsonValue(document.array()) : QJsonValue(document.object()));
+	return corpus;
+}
+
+// Every literal of the corpus, and long texts made of them the size of big messages
+// and code blocks
+QStringList escapeCorpus(const QVector<QJsonArray>& corpus)
+{
+	QStringList result;
+	foreach(const QJsonArray& parsedText, corpus)
+	{
+		foreach(const QJsonValue& block, parsedText)
+		{
+			if(block["literal"].isString()) result << block["literal"].toString();
+			foreach(const QJsonValue& child, block["children"].toArray())
+			{
+				result << child["literal"].toString();
+			}
+		}
+	}
+
+	const int count = result.size();
+	for(int i = 0; i + 100 <= count; i += 100)
+	{
+		result << result.mid(i, 100).join("\n");
+	}
+	return result;
+}
+
+// The old plain text renderer parsed message text as HTML, so tags and entities
+// typed in a message were not shown as written
+bool hasMarkup(const QJsonArray& parsedText)
+{
+	const QByteArray json = QJsonDocument(parsedText).toJson(QJsonDocument::Compact);
+	return json.contains('<') || json.contains('&');
+}
+
+// Microseconds to render every message of the corpus `iterations` times
+template<typename F>
+qint64 measure(int iterations, int count, F render)
+{
+	QElapsedTimer timer;
+	timer.start();
+	qint64 length = 0;
+	for(int i = 0; i < iterations; i++)
+	{
+		for(int m = 0; m < count; m++)
+		{
+			length += render(m).size();
+		}
+	}
+
+	// Keeps the rendering from being optimized away
+	if(length < 0) qWarning() << length;
+	return timer.nsecsElapsed() / 1000;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	QGuiApplication app(argc, argv);
+	const QStringList args = app.arguments();
+	const int iterations = args.size() > 2 ? args[2].toInt() : 20;
+
+	QTextStream out(stdout);
+	QVector<QJsonArray> corpus;
+	if(args.size() > 1)
+	{
+		corpus = loadCorpus(args[1]);
+		if(corpus.isEmpty())
+		{
+			out << "No messages in " << args[1] << "\n";
+			return 1;
+		}
+	}
+	else
+	{
+		QRandomGenerator rng(1);
+		for(int i = 0; i < 10000; i++)
+		{
+			corpus << generateParsedText(rng);
+		}
+	}
+
+	// renderSimpleText takes a message, as the chat list has one per chat
+	QVector<std::shared_ptr<Messages::Message>> messages;
+	foreach(const QJsonArray& parsedText, corpus)
+	{
+		messages << std::make_shared<Messages::Message>(QJsonObject{{"parsedText", parsedText}});
+	}
+	auto html = [&messages](int i) { return Messages::Format::renderBlock(messages[i]->get_parsedText(), nullptr); };
+	auto text = [&messages](int i) { return Messages::Format::renderSimpleText(messages[i].get(), nullptr); };
+	auto expectedHtml = [&corpus](int i) { return Reference::renderBlock(corpus[i]); };
+	auto expectedText = [&corpus](int i) { return Reference::renderSimpleText(corpus[i]); };
+
+	int mismatches = 0;
+	int markup = 0;
+	for(int i = 0; i < corpus.size(); i++)
+	{
+		const QStringList rendered{html(i), expectedHtml(i), text(i), expectedText(i)};
+		if(rendered[0] == rendered[1] && rendered[2] == rendered[3]) continue;
+
+		if(rendered[0] == rendered[1] && hasMarkup(corpus[i]))
+		{
+			markup++;
+			continue;
+		}
+
+		if(mismatches++ < 10)
+		{
+			out << "Message " << i << " differs\n"
+				<< "  parsedText: " << QJsonDocument(corpus[i]).toJson(QJsonDocument::Compact) << "\n";
+			if(rendered[0] != rendered[1]) out << "  html: " << rendered[0] << "\n  expected: " << rendered[1] << "\n";
+			if(rendered[2] != rendered[3]) out << "  text: " << rendered[2] << "\n  expected: " << rendered[3] << "\n";
+		}
+	}
+	out << mismatches << " of " << corpus.size() << " messages differ, and " << markup << " more with < or & in their plain text\n";
+
+	const double rendered = std::max(1, iterations * corpus.size());
+	out << "renderBlock: " << measure(iterations, corpus.size(), html) / rendered << " us per message, was "
+		<< measure(iterations, corpus.size(), expectedHtml) / rendered << " us\n";
+	out << "renderSimpleText: " << measure(iterations, corpus.size(), text) / rendered << " us per message, was "
+		<< measure(iterations, corpus.size(), expectedText) / rendered << " us\n";
+
+	// Decoding the parsedText from status-go, and what it takes in memory, against the
+	// CBOR encoding MessageStore used to keep
+	qint64 astBytes = 0;
+	qint64 cborBytes = 0;
+	for(int i = 0; i < corpus.size(); i++)
+	{
+		astBytes += messages[i]->get_parsedText().memoryUsage();
+		cborBytes += QCborValue(QCborArray::fromJsonArray(corpus[i])).toCbor().size() + 24;
+	}
+	auto decode = [&corpus](int i) { return Messages::ParsedText(corpus[i]).text(); };
+	out << "ParsedText: " << double(astBytes) / corpus.size() << " bytes per message, was " << double(cborBytes) / corpus.size()
+		<< " bytes as CBOR, decoded in " << measure(iterations, corpus.size(), decode) / rendered << " us\n";
+
+	// The escaping alone, against the chain of passes it replaced
+	const QStringList texts = escapeCorpus(corpus);
+	auto escaped = [&texts](int i) {
+		QString result;
+		Messages::Format::appendHtmlEscaped(result, texts[i], QLatin1String("<br />"), true);
+		return result;
+	};
+	auto expectedEscaped = [&texts](int i) { return texts[i].toHtmlEscaped().replace("\r\n", "<br />").replace("\n", "<br />"); };
+
+	for(int i = 0; i < texts.size(); i++)
+	{
+		if(escaped(i) == expectedEscaped(i)) continue;
+		if(mismatches++ < 10) out << "Escaping differs for: " << texts[i] << "\n";
+	}
+
+	qint64 characters = 0;
+	foreach(const QString& text, texts)
+	{
+		characters += text.size();
+	}
+	const double megabytes = iterations * characters * sizeof(QChar) / 1e6;
+	out << "appendHtmlEscaped: " << megabytes / (measure(iterations, texts.size(), escaped) / 1e6) << " MB/s, was "
+		<< megabytes / (measure(iterations, texts.size(), expectedEscaped) / 1e6) << " MB/s\n";
+
+	return mismatches > 0 ? 1 : 0;
+}
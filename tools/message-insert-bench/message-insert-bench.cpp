@@ -0,0 +1,150 @@
+// Insert throughput of MessagesModel for a burst of incoming messages, one
+// message per insert against one insert per batch window. See README.md
+
+#include "contacts-model.hpp"
+#include "message.hpp"
+#include "messages-model.hpp"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QStringList>
+#include <QTextStream>
+#include <QVector>
+#include <algorithm>
+
+using namespace Messages;
+
+namespace
+{
+
+const int authorCount = 50;
+const int visibleRows = 30;
+
+QString hex(QRandomGenerator& rng, int length)
+{
+	static const char digits[] = "0123456789abcdef";
+	QString result("0x");
+	for(int i = 0; i < length; i++)
+	{
+		result += QChar(digits[rng.bounded(16)]);
+	}
+	return result;
+}
+
+// Shaped like a messages.new entry, after the uint64 fields were quoted
+QJsonObject generateMessage(int i, QRandomGenerator& rng, const QVector<QString>& authors)
+{
+	static const QStringList words{"status", "message", "hello", "the", "chat", "is", "working", "fine", "today", "waku", "node", "sync"};
+
+	QStringList text;
+	const int wordCount = 4 + rng.bounded(20);
+	for(int w = 0; w < wordCount; w++)
+	{
+		text << words[rng.bounded(words.size())];
+	}
+
+	const int author = rng.bounded(authors.size());
+	// Backfilled envelopes are only roughly in clock order
+	const qint64 timestamp = 1600000000000ll + (i + rng.bounded(20)) * 1000ll;
+	QJsonObject paragraph{{"type", "paragraph"}, {"children", QJsonArray{QJsonObject{{"literal", text.join(" ")}}}}};
+
+	return QJsonObject{{"id", hex(rng, 64)},
+					   {"alias", QString("Author %1 Name").arg(author)},
+					   {"chatId", "status"},
+					   {"localChatId", "status"},
+					   {"clock", QString::number(timestamp * 1000)},
+					   {"contentType", 1},
+					   {"messageType", 2},
+					   {"from", authors[author]},
+					   {"lineCount", 1},
+					   {"text", text.join(" ")},
+					   {"timestamp", QString::number(timestamp)},
+					   {"whisperTimestamp", QString::number(timestamp)},
+					   {"parsedText", QJsonArray{paragraph}}};
+}
+
+struct Result
+{
+	qint64 elapsedUs = 0;
+	int inserts = 0;
+	int rows = 0;
+};
+
+// Pushes the messages in groups of `batchSize`, while a stand-in for the view
+// reads the rows on screen after every insert
+Result run(const QVector<QJsonObject>& messages, int batchSize, ContactsModel* contacts)
+{
+	MessagesModel model("status", ChatType::Public);
+	model.set_contacts(contacts);
+
+	Result result;
+	QObject::connect(&model, &QAbstractItemModel::rowsInserted, [&model, &result] {
+		result.inserts++;
+		const int rows = std::min(visibleRows, model.rowCount(QModelIndex()));
+		for(int row = 0; row < rows; row++)
+		{
+			const QModelIndex index = model.index(row, 0);
+			model.data(index, MessagesModel::PlainText);
+			model.data(index, MessagesModel::Contact);
+			model.data(index, MessagesModel::Timestamp);
+			model.data(index, MessagesModel::SectionIdentifier);
+		}
+	});
+
+	QElapsedTimer timer;
+	timer.start();
+	for(int i = 0; i < messages.size(); i += batchSize)
+	{
+		QVector<Message*> batch;
+		for(int j = i; j < std::min<int>(messages.size(), i + batchSize); j++)
+		{
+			batch << new Message(messages[j]);
+		}
+		if(batch.size() == 1)
+			model.push(batch[0]);
+		else
+			model.push(batch);
+	}
+	result.elapsedUs = timer.nsecsElapsed() / 1000;
+	result.rows = model.rowCount(QModelIndex());
+	return result;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	QCoreApplication app(argc, argv);
+	const QStringList args = app.arguments();
+	const int count = args.size() > 1 ? std::max(1, args[1].toInt()) : 10000;
+	const int signalSize = args.size() > 2 ? std::max(1, args[2].toInt()) : 10;
+	const int signalsPerWindow = args.size() > 3 ? std::max(1, args[3].toInt()) : 20;
+
+	QRandomGenerator rng(1);
+	QVector<QString> authors;
+	for(int i = 0; i < authorCount; i++)
+	{
+		authors << hex(rng, 130);
+	}
+	QVector<QJsonObject> messages;
+	for(int i = 0; i < count; i++)
+	{
+		messages << generateMessage(i, rng, authors);
+	}
+
+	ContactsModel contacts;
+	QTextStream out(stdout);
+	auto report = [&](const QString& name, const Result& result) {
+		out << name << ": " << result.elapsedUs / 1000 << " ms, "
+			<< qint64(count * 1000000.0 / std::max<qint64>(1, result.elapsedUs)) << " messages/s, " << result.inserts
+			<< " inserts, " << result.rows << " rows\n";
+	};
+
+	report("one insert per message", run(messages, 1, &contacts));
+	report(QString("one insert per signal of %1").arg(signalSize), run(messages, signalSize, &contacts));
+	report(QString("one insert per window of %1 signals").arg(signalsPerWindow), run(messages, signalSize * signalsPerWindow, &contacts));
+
+	return 0;
+}
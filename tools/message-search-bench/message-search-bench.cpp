@@ -0,0 +1,182 @@
+// Build, open and query times of a SearchIndex over generated chat history.
+// See README.md
+
+#include "search-index.hpp"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QMap>
+#include <QRandomGenerator>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QVector>
+#include <algorithm>
+#include <cmath>
+
+using namespace Messages;
+
+namespace
+{
+
+const int vocabularySize = 20000;
+const int authorCount = 500;
+const int chatCount = 100;
+const int flushSize = 5000;
+const int queriesPerKind = 500;
+
+QString word(int i)
+{
+	// Pronounceable, and sharing prefixes the way real words do
+	static const char* syllables[] = {"ka", "lo", "mi", "ne", "su", "ta", "ri", "po", "ve", "da", "zu", "he", "qi", "fo", "bu", "ja"};
+	QString result;
+	do
+	{
+		result += syllables[i % 16];
+		i /= 16;
+	} while(i > 0);
+	return result;
+}
+
+// Rank of a word under a Zipf distribution, by inverse transform over the cumulative weights
+class Zipf
+{
+public:
+	explicit Zipf(int size)
+	{
+		double total = 0;
+		for(int i = 1; i <= size; i++)
+		{
+			total += 1.0 / i;
+			m_cumulative << total;
+		}
+	}
+
+	int next(QRandomGenerator& rng) const
+	{
+		const double value = rng.generateDouble() * m_cumulative.last();
+		return std::lower_bound(m_cumulative.begin(), m_cumulative.end(), value) - m_cumulative.begin();
+	}
+
+private:
+	QVector<double> m_cumulative;
+};
+
+QString hex(QRandomGenerator& rng, int length)
+{
+	static const char digits[] = "0123456789abcdef";
+	QString result("0x");
+	for(int i = 0; i < length; i++)
+	{
+		result += QChar(digits[rng.bounded(16)]);
+	}
+	return result;
+}
+
+struct Latency
+{
+	QVector<qint64> samples;
+	int hits = 0;
+
+	QString report() const
+	{
+		QVector<qint64> sorted = samples;
+		std::sort(sorted.begin(), sorted.end());
+		auto percentile = [&sorted](double p) { return sorted.isEmpty() ? 0 : sorted[std::min<int>(sorted.size() - 1, sorted.size() * p)]; };
+		return QString("p50 %1 us, p95 %2 us, p99 %3 us, max %4 us, %5 hits per query")
+			.arg(percentile(0.5))
+			.arg(percentile(0.95))
+			.arg(percentile(0.99))
+			.arg(sorted.isEmpty() ? 0 : sorted.last())
+			.arg(samples.isEmpty() ? 0 : hits / samples.size());
+	}
+};
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	QCoreApplication app(argc, argv);
+	const QStringList args = app.arguments();
+	const int count = args.size() > 1 ? args[1].toInt() : 1000000;
+
+	QTemporaryDir temporary;
+	const QString path = args.size() > 2 ? args[2] : temporary.path();
+
+	QTextStream out(stdout);
+	QRandomGenerator rng(1);
+	const Zipf zipf(vocabularySize);
+
+	QVector<QString> authors;
+	QVector<QString> aliases;
+	for(int i = 0; i < authorCount; i++)
+	{
+		authors << hex(rng, 130);
+		aliases << QString("%1 %2 %3").arg(word(rng.bounded(4096)), word(rng.bounded(4096)), word(rng.bounded(4096)));
+	}
+	QVector<QString> chats;
+	for(int i = 0; i < chatCount; i++)
+	{
+		chats << word(i + 100);
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+	{
+		SearchIndex index(path);
+		index.open();
+		for(int i = 0; i < count; i++)
+		{
+			QStringList text;
+			const int wordCount = 3 + rng.bounded(20);
+			for(int w = 0; w < wordCount; w++)
+			{
+				text << word(zipf.next(rng));
+			}
+
+			const int author = rng.bounded(authorCount);
+			index.add(SearchIndex::Document{hex(rng, 64), chats[rng.bounded(chatCount)], authors[author], aliases[author],
+											1600000000000ull + i, text.join(" ")});
+			if((i + 1) % flushSize == 0)
+			{
+				index.flush();
+				index.compact();
+			}
+		}
+		index.flush();
+		index.compact();
+		out << "indexed " << count << " messages in " << timer.elapsed() << " ms\n";
+	}
+
+	timer.restart();
+	SearchIndex index(path);
+	index.open();
+	out << "opened in " << timer.elapsed() << " ms, " << index.stats()["segments"].toInt() << " segments\n";
+
+	QMap<QString, Latency> latencies;
+	auto run = [&](const QString& kind, const QString& query, const QString& chatId) {
+		QElapsedTimer queryTimer;
+		queryTimer.start();
+		const int hits = index.search(query, chatId, 50).size();
+		latencies[kind].samples << queryTimer.nsecsElapsed() / 1000;
+		latencies[kind].hits += hits;
+	};
+
+	for(int i = 0; i < queriesPerKind; i++)
+	{
+		const QString common = word(zipf.next(rng));
+		const QString rare = word(rng.bounded(vocabularySize));
+		run("word", rare, QString());
+		run("common word", common, QString());
+		run("prefix", rare.left(std::max(2, rare.size() - 2)), QString());
+		run("two words", common + " " + rare, QString());
+		run("from", "from:" + aliases[rng.bounded(authorCount)].section(' ', 0, 0) + " " + common, QString());
+		run("in chat", common, chats[rng.bounded(chatCount)]);
+	}
+
+	for(auto it = latencies.constBegin(); it != latencies.constEnd(); ++it)
+	{
+		out << it.key() << ": " << it.value().report() << "\n";
+	}
+
+	return 0;
+}
@@ -0,0 +1,164 @@
+// Resident memory of a chat history kept as one Message QObject per message,
+// the way MessagesModel used to hold it, against the same history in a
+// MessageStore. See README.md
+
+#include "message-store.hpp"
+#include "message.hpp"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QMap>
+#include <QProcess>
+#include <QRandomGenerator>
+#include <QStringList>
+#include <QTextStream>
+#include <QVector>
+#include <unistd.h>
+
+using namespace Messages;
+
+namespace
+{
+
+const int authorCount = 50;
+
+qint64 residentBytes()
+{
+	QFile statm("/proc/self/statm");
+	if(!statm.open(QIODevice::ReadOnly)) return 0;
+	const QList<QByteArray> fields = statm.readAll().split(' ');
+	return fields.size() > 1 ? fields[1].toLongLong() * sysconf(_SC_PAGESIZE) : 0;
+}
+
+QString hex(QRandomGenerator& rng, int length)
+{
+	static const char digits[] = "0123456789abcdef";
+	QString result("0x");
+	for(int i = 0; i < length; i++)
+	{
+		result += QChar(digits[rng.bounded(16)]);
+	}
+	return result;
+}
+
+// Shaped like a wakuext_chatMessages entry. Authors repeat, and carry the same
+// alias and identicon on every message, as status-go sends them
+QJsonObject generateMessage(int i, QRandomGenerator& rng, const QVector<QJsonObject>& authors)
+{
+	static const QStringList words{"status", "message", "hello", "the", "chat", "is", "working", "fine", "today", "waku", "node", "sync"};
+
+	QStringList text;
+	const int wordCount = 4 + rng.bounded(20);
+	for(int w = 0; w < wordCount; w++)
+	{
+		text << words[rng.bounded(words.size())];
+	}
+
+	const QJsonObject& author = authors[rng.bounded(authors.size())];
+	const qint64 timestamp = 1600000000000ll + i * 1000ll;
+	QJsonObject paragraph{{"type", "paragraph"}, {"children", QJsonArray{QJsonObject{{"literal", text.join(" ")}}}}};
+
+	return QJsonObject{{"id", hex(rng, 64)},
+					   {"alias", author["alias"]},
+					   {"chatId", "status"},
+					   {"localChatId", "status"},
+					   {"clock", QString::number(timestamp * 1000)},
+					   {"contentType", 1},
+					   {"messageType", 2},
+					   {"from", author["from"]},
+					   {"identicon", author["identicon"]},
+					   {"lineCount", 1},
+					   {"seen", true},
+					   {"text", text.join(" ")},
+					   {"timestamp", QString::number(timestamp)},
+					   {"whisperTimestamp", QString::number(timestamp)},
+					   {"parsedText", QJsonArray{paragraph}},
+					   {"outgoingStatus", i % 10 == 0 ? "sent" : ""}};
+}
+
+QVector<QJsonObject> generateAuthors(QRandomGenerator& rng)
+{
+	QVector<QJsonObject> authors;
+	for(int i = 0; i < authorCount; i++)
+	{
+		// Identicons are base64 PNGs of around 1.5KB
+		QString identicon("data:image/png;base64,");
+		identicon += QString("A").repeated(1500);
+		authors << QJsonObject{{"from", hex(rng, 130)}, {"alias", QString("Author %1 Name").arg(i)}, {"identicon", identicon}};
+	}
+	return authors;
+}
+
+int run(const QString& mode, int count)
+{
+	QRandomGenerator rng(1);
+	const QVector<QJsonObject> authors = generateAuthors(rng);
+
+	QObject parent;
+	QVector<Message*> objects;
+	MessageStore store;
+
+	const qint64 before = residentBytes();
+	QElapsedTimer timer;
+	timer.start();
+
+	for(int i = 0; i < count; i++)
+	{
+		Message* message = new Message(generateMessage(i, rng, authors));
+		if(mode == "objects")
+		{
+			message->setParent(&parent);
+			objects << message;
+		}
+		else
+		{
+			store.add(message);
+			delete message;
+		}
+	}
+
+	QTextStream(stdout) << mode << " " << count << " " << (residentBytes() - before) << " " << timer.elapsed() << "\n";
+	return 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	QCoreApplication app(argc, argv);
+	const QStringList args = app.arguments();
+
+	const int count = args.size() > 2 ? args[2].toInt() : 100000;
+	if(args.size() > 1 && args[1] != "compare")
+	{
+		return run(args[1], count);
+	}
+
+	// Each layout is measured in its own process, so memory released by one run
+	// can't be reused by the other
+	QTextStream out(stdout);
+	QMap<QString, qint64> resident;
+	foreach(const QString& mode, QStringList({"objects", "store"}))
+	{
+		QProcess process;
+		process.start(app.applicationFilePath(), {mode, QString::number(count)});
+		if(!process.waitForFinished(-1) || process.exitCode() != 0)
+		{
+			out << "Could not run " << mode << "\n";
+			return 1;
+		}
+
+		const QStringList result = QString::fromUtf8(process.readAllStandardOutput()).trimmed().split(' ');
+		resident[mode] = result.value(2).toLongLong();
+		out << mode << ": " << resident[mode] / 1024 << " KB resident for " << count << " messages, " << result.value(3) << " ms\n";
+	}
+
+	if(resident["store"] > 0)
+	{
+		out << "ratio: " << double(resident["objects"]) / resident["store"] << "x\n";
+	}
+
+	return 0;
+}
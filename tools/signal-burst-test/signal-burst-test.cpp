@@ -0,0 +1,114 @@
+// SignalPipeline must not hold back the libstatus thread while the UI thread is
+// busy. See README.md
+
+#include "libstatus.h"
+#include "signal-pipeline.hpp"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QStringList>
+#include <QTextStream>
+#include <QThread>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+
+namespace
+{
+
+const qint64 maxPushNs = 10 * 1000 * 1000;
+
+SignalPipeline* pipeline = nullptr;
+std::atomic<quint64> pushes{0};
+std::atomic<qint64> longestPushNs{0};
+
+void signalCallback(const char* data)
+{
+	QElapsedTimer timer;
+	timer.start();
+	pipeline->push(QByteArray(data));
+	const qint64 elapsed = timer.nsecsElapsed();
+
+	pushes++;
+	qint64 longest = longestPushNs;
+	while(elapsed > longest && !longestPushNs.compare_exchange_weak(longest, elapsed))
+	{ }
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	if(qEnvironmentVariableIsEmpty("FAKE_LIBSTATUS_SIGNAL_RATE")) qputenv("FAKE_LIBSTATUS_SIGNAL_RATE", "5000");
+
+	QCoreApplication app(argc, argv);
+	const QStringList args = app.arguments();
+	const int busyMs = args.size() > 1 ? std::max(1, args[1].toInt()) : 2000;
+	const double rate = qEnvironmentVariable("FAKE_LIBSTATUS_SIGNAL_RATE").toDouble();
+
+	// Small enough for the burst to go far past it
+	SignalPipeline signalPipeline(2, 64);
+	pipeline = &signalPipeline;
+
+	quint64 delivered = 0;
+	int reordered = 0;
+	qint64 lastSequence = -1;
+	QObject::connect(&signalPipeline, &SignalPipeline::signalsDecoded, [&](QVector<QJsonObject> signalEvents) {
+		foreach(const QJsonObject& signalEvent, signalEvents)
+		{
+			delivered++;
+			if(signalEvent["type"].toString() != "messages.new") continue;
+
+			foreach(const QJsonValue& message, signalEvent["event"]["messages"].toArray())
+			{
+				const qint64 sequence = message["text"].toString().section(' ', -1).toLongLong();
+				if(sequence <= lastSequence) reordered++;
+				lastSequence = sequence;
+			}
+		}
+	});
+
+	SetSignalEventCallback((void*)&signalCallback);
+	free(Login(const_cast<char*>(""), const_cast<char*>("")));
+
+	// The UI thread is busy: nothing is flushed while the burst arrives
+	QThread::msleep(busyMs);
+	const quint64 pushedWhileBusy = pushes;
+
+	free(Logout());
+	const quint64 pushed = pushes;
+
+	QElapsedTimer drain;
+	drain.start();
+	while(delivered < pushed && drain.elapsed() < 10000)
+	{
+		app.processEvents(QEventLoop::AllEvents, 50);
+	}
+
+	const QVariantMap stats = signalPipeline.stats();
+	const quint64 expected = quint64(rate * busyMs / 1000);
+
+	QTextStream out(stdout);
+	out << pushedWhileBusy << " of ~" << expected << " signals pushed while the UI thread was busy, longest push "
+		<< longestPushNs / 1000 << " us, " << stats["stalled"].toULongLong() << " stalled, high water mark "
+		<< stats["highWaterMark"].toInt() << ", " << delivered << " of " << pushed << " delivered, " << reordered << " out of order\n";
+
+	bool ok = true;
+	if(longestPushNs > maxPushNs)
+	{
+		out << "FAIL: push held the libstatus thread\n";
+		ok = false;
+	}
+	if(pushedWhileBusy < expected / 2)
+	{
+		out << "FAIL: the burst was held back while the UI thread was busy\n";
+		ok = false;
+	}
+	if(delivered != pushed || reordered > 0)
+	{
+		out << "FAIL: signals were lost or reordered\n";
+		ok = false;
+	}
+	return ok ? 0 : 1;
+}